@@ -0,0 +1,386 @@
+#include <stdio.h>
+#include <string.h>
+#include "compressed_list.h"
+
+// ********* Chunk encoding *********
+
+// Maps signed differences to unsigned ones so that small steps either way stay small
+static inline uint32_t zigzag(int32_t delta) {
+    return ((uint32_t)delta << 1) ^ (uint32_t)(delta >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t value) {
+    return (int32_t)(value >> 1) ^ -(int32_t)(value & 1);
+}
+
+static inline int varint_length(uint32_t value) {
+    return value < 0x80 ? 1 : value < 0x4000 ? 2 : 3;
+}
+
+// Writes value 7 bits per byte, low bits first, with the top bit set on every byte
+// but the last. Returns the number of bytes written.
+static inline int put_varint(uint8_t* out, uint32_t value) {
+    int length = 0;
+    while (value >= 0x80) {
+        out[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = (uint8_t)value;
+    return length;
+}
+
+static inline uint32_t get_varint(const uint8_t** in) {
+    uint32_t value = 0;
+    int shift = 0;
+    uint8_t byte;
+    do {
+        byte = *(*in)++;
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return value;
+}
+
+// Decodes the values of a chunk into out, which must have CLIST_CHUNK_CAPACITY slots
+static int decode_chunk(const CompressedChunk* chunk, uint16_t* out) {
+    const uint8_t* in = chunk->deltas;
+    uint16_t value = chunk->first;
+    out[0] = value;
+    for (int i = 1; i < chunk->count; i++) {
+        value = (uint16_t)(value + unzigzag(get_varint(&in)));
+        out[i] = value;
+    }
+    return chunk->count;
+}
+
+// Appends a value to a non-empty chunk. Returns 0 if its delta does not fit.
+static int append_to_chunk(CompressedChunk* chunk, uint16_t data) {
+    uint32_t delta = zigzag((int32_t)data - (int32_t)chunk->last);
+    if (chunk->used + varint_length(delta) > CLIST_DELTA_BYTES) {
+        return 0;
+    }
+    chunk->used += put_varint(chunk->deltas + chunk->used, delta);
+    chunk->count++;
+    chunk->last = data;
+    if (data < chunk->min) {
+        chunk->min = data;
+    }
+    if (data > chunk->max) {
+        chunk->max = data;
+    }
+    return 1;
+}
+
+// Re-encodes the chunk from values and returns how many of them fit
+static int encode_chunk(CompressedChunk* chunk, const uint16_t* values, int count) {
+    chunk->first = chunk->last = chunk->min = chunk->max = values[0];
+    chunk->count = 1;
+    chunk->used = 0;
+    for (int i = 1; i < count && append_to_chunk(chunk, values[i]); i++) {
+    }
+    return chunk->count;
+}
+
+static CompressedChunk* new_chunk(void) {
+    CompressedChunk* chunk = (CompressedChunk*)mem_alloc(sizeof(CompressedChunk));
+    if (!chunk) {
+        printf("Memory allocation failed\n");
+        return NULL;
+    }
+    chunk->next = NULL;
+    chunk->count = 0;
+    chunk->used = 0;
+    return chunk;
+}
+
+// Links a chunk in after prev, or at the head when prev is NULL.
+// Caller must hold the list lock.
+static void link_chunk(CompressedList* list, CompressedChunk* prev, CompressedChunk* chunk) {
+    if (prev == NULL) {
+        chunk->next = list->head;
+        list->head = chunk;
+    } else {
+        chunk->next = prev->next;
+        prev->next = chunk;
+    }
+    if (list->tail == prev) {
+        list->tail = chunk;
+    }
+    list->chunks++;
+}
+
+// An insert grows the deltas of a chunk by at most this many bytes: the delta it
+// replaces becomes two deltas of up to 3 bytes each
+#define CLIST_INSERT_GROWTH 5
+
+// Re-encodes the values into chunk. If they do not fit, the first half stays and
+// the rest moves to spare, linked in after chunk; otherwise spare is freed.
+// Caller must hold the list lock.
+static void store_values(CompressedList* list, CompressedChunk* chunk, CompressedChunk* spare,
+                         const uint16_t* values, int count) {
+    if (encode_chunk(chunk, values, count) == count) {
+        if (spare) {
+            mem_free(spare);
+        }
+        return;
+    }
+    int keep = count / 2;
+    encode_chunk(chunk, values, keep);
+    encode_chunk(spare, values + keep, count - keep);
+    link_chunk(list, chunk, spare);
+}
+
+// Unlinks and frees a chunk. Caller must hold the list lock.
+static void remove_chunk(CompressedList* list, CompressedChunk* previous, CompressedChunk* chunk) {
+    if (previous == NULL) {
+        list->head = chunk->next;
+    } else {
+        previous->next = chunk->next;
+    }
+    if (list->tail == chunk) {
+        list->tail = previous;
+    }
+    list->chunks--;
+    mem_free(chunk);
+}
+
+// ********* List operations *********
+
+// Initializes the compressed list and memory manager
+void clist_init(CompressedList* list, size_t size) {
+    list->head = NULL;
+    list->tail = NULL;
+    list->count = 0;
+    list->chunks = 0;
+    pthread_mutex_init(&list->lock, NULL);
+    mem_init(size);
+}
+
+// Inserts a value at the end of the list
+void clist_insert(CompressedList* list, uint16_t data) {
+    pthread_mutex_lock(&list->lock);
+
+    if (list->tail == NULL || !append_to_chunk(list->tail, data)) {
+        CompressedChunk* chunk = new_chunk();
+        if (!chunk) {
+            pthread_mutex_unlock(&list->lock);
+            return;
+        }
+        encode_chunk(chunk, &data, 1);
+        link_chunk(list, list->tail, chunk);
+    }
+    list->count++;
+
+    pthread_mutex_unlock(&list->lock);
+}
+
+// Inserts a value right after the given position, splitting the chunk if it overflows
+void clist_insert_after(CompressedList* list, CListPos pos, uint16_t data) {
+    if (!pos.chunk) {
+        printf("Previous node cannot be NULL\n");
+        return;
+    }
+
+    pthread_mutex_lock(&list->lock);
+
+    CompressedChunk* chunk = pos.chunk;
+    CompressedChunk* spare = NULL;
+    if (chunk->used + CLIST_INSERT_GROWTH > CLIST_DELTA_BYTES) {
+        spare = new_chunk();
+        if (!spare) {
+            pthread_mutex_unlock(&list->lock);
+            return;
+        }
+    }
+
+    uint16_t values[CLIST_CHUNK_CAPACITY + 1];
+    int count = decode_chunk(chunk, values);
+    int index = pos.index + 1;
+    memmove(values + index + 1, values + index, (count - index) * sizeof(uint16_t));
+    values[index] = data;
+    store_values(list, chunk, spare, values, count + 1);
+    list->count++;
+
+    pthread_mutex_unlock(&list->lock);
+}
+
+// Deletes the first occurrence of the value. Empty chunks are freed and a chunk that
+// drops below a quarter full absorbs its successor when both fit in one chunk.
+void clist_delete(CompressedList* list, uint16_t data) {
+    pthread_mutex_lock(&list->lock);
+
+    if (list->head == NULL) {
+        printf("List is empty\n");
+        pthread_mutex_unlock(&list->lock);
+        return;
+    }
+
+    uint16_t values[2 * CLIST_CHUNK_CAPACITY];
+    CompressedChunk* previous = NULL;
+    CompressedChunk* chunk = list->head;
+    int count = 0;
+    int index = -1;
+    for (; chunk != NULL; previous = chunk, chunk = chunk->next) {
+        if (data < chunk->min || data > chunk->max) {
+            continue;
+        }
+        count = decode_chunk(chunk, values);
+        for (index = 0; index < count && values[index] != data; index++) {
+        }
+        if (index < count) {
+            break;
+        }
+    }
+
+    if (chunk == NULL) {
+        printf("Data not found in the list\n");
+        pthread_mutex_unlock(&list->lock);
+        return;
+    }
+
+    list->count--;
+    if (--count == 0) {
+        remove_chunk(list, previous, chunk);
+        pthread_mutex_unlock(&list->lock);
+        return;
+    }
+
+    // Dropping a value never makes the deltas longer, so the rest still fits
+    memmove(values + index, values + index + 1, (count - index) * sizeof(uint16_t));
+    CompressedChunk* next = chunk->next;
+    if (chunk->count < CLIST_CHUNK_CAPACITY / 4 && next != NULL &&
+        chunk->used + next->used + 3 <= CLIST_DELTA_BYTES) {
+        count += decode_chunk(next, values + count);
+        remove_chunk(list, chunk, next);
+    }
+    encode_chunk(chunk, values, count);
+
+    pthread_mutex_unlock(&list->lock);
+}
+
+// Searches for the first occurrence of the value, skipping chunks whose range
+// cannot hold it
+CListPos clist_search(CompressedList* list, uint16_t data) {
+    pthread_mutex_lock(&list->lock);
+
+    CListPos pos = {NULL, 0};
+    for (CompressedChunk* chunk = list->head; chunk != NULL && pos.chunk == NULL; chunk = chunk->next) {
+        if (data < chunk->min || data > chunk->max) {
+            continue;
+        }
+        const uint8_t* in = chunk->deltas;
+        uint16_t value = chunk->first;
+        for (int i = 0; i < chunk->count; i++) {
+            if (i > 0) {
+                value = (uint16_t)(value + unzigzag(get_varint(&in)));
+            }
+            if (value == data) {
+                pos.chunk = chunk;
+                pos.index = i;
+                break;
+            }
+        }
+    }
+
+    pthread_mutex_unlock(&list->lock);
+    return pos;
+}
+
+// Decodes the value at a position
+uint16_t clist_value(CListPos pos) {
+    const uint8_t* in = pos.chunk->deltas;
+    uint16_t value = pos.chunk->first;
+    for (int i = 0; i < pos.index; i++) {
+        value = (uint16_t)(value + unzigzag(get_varint(&in)));
+    }
+    return value;
+}
+
+// Displays all values in the list
+void clist_display(CompressedList* list) {
+    clist_display_range(list, (CListPos){NULL, 0}, (CListPos){NULL, 0});
+    printf("\n");
+}
+
+// Displays the values from start to end inclusive; a NULL chunk means the first or
+// last value respectively
+void clist_display_range(CompressedList* list, CListPos start, CListPos end) {
+    pthread_mutex_lock(&list->lock);
+
+    uint16_t values[CLIST_CHUNK_CAPACITY];
+    CompressedChunk* chunk = start.chunk ? start.chunk : list->head;
+    int index = start.chunk ? start.index : 0;
+    int first = 1;
+
+    printf("[");
+    while (chunk != NULL) {
+        int count = decode_chunk(chunk, values);
+        int last = (chunk == end.chunk) ? end.index : count - 1;
+        for (int i = index; i <= last; i++) {
+            printf(first ? "%u" : ", %u", values[i]);
+            first = 0;
+        }
+        if (chunk == end.chunk) {
+            break;
+        }
+        chunk = chunk->next;
+        index = 0;
+    }
+    printf("]");
+
+    pthread_mutex_unlock(&list->lock);
+}
+
+// Counts the values in the list
+size_t clist_count_nodes(CompressedList* list) {
+    pthread_mutex_lock(&list->lock);
+    size_t count = list->count;
+    pthread_mutex_unlock(&list->lock);
+    return count;
+}
+
+// Copies up to max values out in list order
+size_t clist_to_array(CompressedList* list, uint16_t* out, size_t max) {
+    pthread_mutex_lock(&list->lock);
+
+    uint16_t values[CLIST_CHUNK_CAPACITY];
+    size_t written = 0;
+    for (CompressedChunk* chunk = list->head; chunk != NULL && written < max; chunk = chunk->next) {
+        int count = decode_chunk(chunk, values);
+        size_t take = (size_t)count < max - written ? (size_t)count : max - written;
+        memcpy(out + written, values, take * sizeof(uint16_t));
+        written += take;
+    }
+
+    pthread_mutex_unlock(&list->lock);
+    return written;
+}
+
+// Pool bytes taken by the chunks
+size_t clist_memory(CompressedList* list) {
+    pthread_mutex_lock(&list->lock);
+    size_t bytes = list->chunks * sizeof(CompressedChunk);
+    pthread_mutex_unlock(&list->lock);
+    return bytes;
+}
+
+// Frees all chunks in the list and deallocates the memory manager
+void clist_cleanup(CompressedList* list) {
+    pthread_mutex_lock(&list->lock);
+
+    CompressedChunk* chunk = list->head;
+    while (chunk != NULL) {
+        CompressedChunk* next = chunk->next;
+        mem_free(chunk);
+        chunk = next;
+    }
+    list->head = NULL;
+    list->tail = NULL;
+    list->count = 0;
+    list->chunks = 0;
+
+    mem_deinit();
+
+    pthread_mutex_unlock(&list->lock);
+    pthread_mutex_destroy(&list->lock);
+}
@@ -0,0 +1,70 @@
+// compressed_list.h
+#ifndef COMPRESSED_LIST_H
+#define COMPRESSED_LIST_H
+
+#include "memory_manager.h"
+#include <stdint.h>
+#include <pthread.h>
+
+// Delta bytes per chunk, chosen so that a chunk fills four 64-byte cache lines
+#define CLIST_DELTA_BYTES 236
+// A chunk holds its first value plus at most one value per delta byte
+#define CLIST_CHUNK_CAPACITY (CLIST_DELTA_BYTES + 1)
+
+// Each chunk stores its first value as is and every following value as the
+// zigzag varint of its difference to the previous one: 1 byte for steps up to
+// +-63, 2 bytes up to +-8191, 3 bytes beyond. min and max let searches skip
+// chunks without decoding them.
+typedef struct CompressedChunk
+{
+    struct CompressedChunk *next;      // Pointer to the next chunk in the list
+    uint16_t count;                    // Number of values in this chunk
+    uint16_t used;                     // Bytes used in deltas
+    uint16_t first;                    // First value
+    uint16_t last;                     // Last value, the base for appended deltas
+    uint16_t min;                      // Smallest value in the chunk
+    uint16_t max;                      // Largest value in the chunk
+    uint8_t deltas[CLIST_DELTA_BYTES]; // Encoded differences, in list order
+} CompressedChunk;
+
+// Compressed linked list: same semantics as the Node and unrolled lists, with
+// values delta-encoded in chunks. Lists of nearby values take about one byte
+// per value. Traversals decode a chunk at a time; inserting into or deleting
+// from the middle of a chunk re-encodes it, splitting it when it overflows.
+typedef struct CompressedList
+{
+    CompressedChunk *head;
+    CompressedChunk *tail;
+    size_t count;  // Number of values in the list
+    size_t chunks; // Number of chunks in the list
+    pthread_mutex_t lock;
+} CompressedList;
+
+// Position of a value in a compressed list; chunk is NULL for "no position".
+// Positions are invalidated by any change to the list.
+typedef struct CListPos
+{
+    CompressedChunk *chunk;
+    uint16_t index;
+} CListPos;
+
+// Function declarations
+void clist_init(CompressedList *list, size_t size);
+void clist_insert(CompressedList *list, uint16_t data);
+void clist_insert_after(CompressedList *list, CListPos pos, uint16_t data);
+void clist_delete(CompressedList *list, uint16_t data);
+CListPos clist_search(CompressedList *list, uint16_t data);
+// Returns the value at a position found by clist_search
+uint16_t clist_value(CListPos pos);
+
+void clist_display(CompressedList *list);
+void clist_display_range(CompressedList *list, CListPos start, CListPos end);
+
+size_t clist_count_nodes(CompressedList *list);
+// Copies up to max values out in list order and returns how many were copied
+size_t clist_to_array(CompressedList *list, uint16_t *out, size_t max);
+// Pool bytes taken by the chunks
+size_t clist_memory(CompressedList *list);
+void clist_cleanup(CompressedList *list);
+
+#endif // COMPRESSED_LIST_H
@@ -0,0 +1,106 @@
+#include <stdlib.h>
+#include <sched.h>
+#include <pthread.h>
+#include "epoch.h"
+
+// Every thread that has read owns one record, holding the epoch it entered its
+// read section in, or 0 when it is outside one. Records sit on their own cache
+// line so that readers on different cores do not share lines.
+typedef struct EpochRecord {
+    uint64_t epoch;
+    int in_use;
+    struct EpochRecord* next;
+} __attribute__((aligned(64))) EpochRecord;
+
+static uint64_t global_epoch = 1;
+static EpochRecord* records = NULL; // Append-only; records are reused, never freed
+
+static __thread EpochRecord* my_record = NULL;
+static __thread int my_depth = 0; // Read sections this thread has open
+static pthread_key_t record_key;
+static pthread_once_t record_key_once = PTHREAD_ONCE_INIT;
+
+// Hands the record of an exiting thread to the next thread that needs one
+static void release_record(void* record) {
+    __atomic_store_n(&((EpochRecord*)record)->in_use, 0, __ATOMIC_RELEASE);
+}
+
+static void create_record_key(void) {
+    pthread_key_create(&record_key, release_record);
+}
+
+static EpochRecord* acquire_record(void) {
+    pthread_once(&record_key_once, create_record_key);
+
+    EpochRecord* record;
+    for (record = __atomic_load_n(&records, __ATOMIC_ACQUIRE); record != NULL; record = record->next) {
+        int expected = 0;
+        if (__atomic_compare_exchange_n(&record->in_use, &expected, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+            break;
+        }
+    }
+
+    if (record == NULL) {
+        record = (EpochRecord*)aligned_alloc(64, sizeof(EpochRecord));
+        if (!record) {
+            abort(); // A reader without a record could see its nodes reused
+        }
+        record->epoch = 0;
+        record->in_use = 1;
+        record->next = __atomic_load_n(&records, __ATOMIC_RELAXED);
+        while (!__atomic_compare_exchange_n(&records, &record->next, record, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+        }
+    }
+
+    pthread_setspecific(record_key, record);
+    return record;
+}
+
+void epoch_enter(void) {
+    if (my_depth++ > 0) {
+        return; // Already protected by the outermost section
+    }
+    EpochRecord* record = my_record;
+    if (record == NULL) {
+        record = my_record = acquire_record();
+    }
+    // Publishing the epoch must be ordered before the reader's first load of a link
+    __atomic_store_n(&record->epoch, __atomic_load_n(&global_epoch, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+}
+
+void epoch_exit(void) {
+    if (--my_depth > 0) {
+        return;
+    }
+    __atomic_store_n(&my_record->epoch, 0, __ATOMIC_RELEASE);
+}
+
+uint64_t epoch_stamp(void) {
+    return __atomic_load_n(&global_epoch, __ATOMIC_SEQ_CST);
+}
+
+// A reader that entered in epoch e may hold any object stamped e or later; one
+// that entered after the epoch moved past a stamp cannot reach that object.
+uint64_t epoch_reclaim_bound(void) {
+    uint64_t bound = __atomic_add_fetch(&global_epoch, 1, __ATOMIC_SEQ_CST);
+    for (EpochRecord* record = __atomic_load_n(&records, __ATOMIC_ACQUIRE); record != NULL; record = record->next) {
+        uint64_t epoch = __atomic_load_n(&record->epoch, __ATOMIC_SEQ_CST);
+        if (epoch != 0 && epoch < bound) {
+            bound = epoch;
+        }
+    }
+    return bound;
+}
+
+void epoch_synchronize(void) {
+    uint64_t target = __atomic_add_fetch(&global_epoch, 1, __ATOMIC_SEQ_CST);
+    for (EpochRecord* record = __atomic_load_n(&records, __ATOMIC_ACQUIRE); record != NULL; record = record->next) {
+        for (;;) {
+            uint64_t epoch = __atomic_load_n(&record->epoch, __ATOMIC_SEQ_CST);
+            if (epoch == 0 || epoch >= target) {
+                break;
+            }
+            sched_yield();
+        }
+    }
+}
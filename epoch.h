@@ -0,0 +1,27 @@
+// epoch.h
+#ifndef EPOCH_H
+#define EPOCH_H
+
+#include <stdint.h>
+
+// Epoch-based reclamation for lock-free readers. A reader brackets its traversal
+// with epoch_enter/epoch_exit and never blocks. A writer that unlinks an object
+// stamps it with epoch_stamp() and may only reuse it once the stamp is below the
+// bound returned by epoch_reclaim_bound(), or after epoch_synchronize() returns.
+// Read sections may nest; only the outermost one is published. A thread must not
+// call epoch_synchronize() from inside a read section, as it would wait on itself.
+
+void epoch_enter(void);
+void epoch_exit(void);
+
+// Stamp for an object that was unlinked before this call
+uint64_t epoch_stamp(void);
+
+// Starts a new epoch and returns the oldest epoch a running reader may still
+// observe; objects stamped below it are no longer reachable by any reader
+uint64_t epoch_reclaim_bound(void);
+
+// Waits until every read section running at the time of the call has finished
+void epoch_synchronize(void);
+
+#endif // EPOCH_H
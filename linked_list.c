@@ -1,232 +1,1825 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <stdint.h>
+#include <string.h>
 #include <pthread.h>
-#include "memory_manager.h"
-// Define the Node structure
-typedef struct Node {
-    uint16_t data;
-    struct Node* next;
-} Node;
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "linked_list.h"
+#include "epoch.h"
 
-// Global mutex for thread synchronization
-static pthread_mutex_t list_mutex = PTHREAD_MUTEX_INITIALIZER;
+// Every List has its own lock and node freelist, so unrelated lists never contend;
+// they only meet in the memory manager when a freelist needs another chunk.
+// Writers serialize on the list lock. Readers (find, print, length, to_array,
+// iterators and their Node ** counterparts) take no lock: they run inside an
+// epoch read section and follow links loaded with acquire, while writers publish
+// links with release stores and keep unlinked nodes intact until every reader that
+// might be on them has left (see "Deferred node reuse" below).
 
-// Initializes the linked list and memory manager
-void list_init(Node** head, size_t size) {
-    *head = NULL;
-    mem_init(size);
+// List behind the Node ** compatibility functions
+static List default_list = {.lock = PTHREAD_MUTEX_INITIALIZER};
+
+static inline Node* load_link(Node** link) {
+    return __atomic_load_n(link, __ATOMIC_ACQUIRE);
 }
 
-// Inserts a new node at the end of the list
-void list_insert(Node** head, uint16_t data) {
-    pthread_mutex_lock(&list_mutex);
+static inline void publish_link(Node** link, Node* node) {
+    __atomic_store_n(link, node, __ATOMIC_RELEASE);
+}
+
+static inline void set_count(List* list, size_t count) {
+    __atomic_store_n(&list->count, count, __ATOMIC_RELAXED);
+}
+
+// ********* Value index (caller holds the list lock) *********
+// For every value the index keeps the link (&list->head or &previous->next) that
+// points at the first node holding it, plus the number of nodes holding it. A link
+// stays valid until the node owning it is removed or a node is inserted right after
+// it, and both cases update the entries of the affected neighbours.
+
+struct ListIndex {
+    Node** first[LIST_INDEX_KEYS];  // Link to the first node with each value, NULL if none
+    uint32_t count[LIST_INDEX_KEYS]; // Number of nodes with each value
+};
+
+// Readers look entries up without the lock
+static inline void set_first(struct ListIndex* index, uint16_t value, Node** link) {
+    __atomic_store_n(&index->first[value], link, __ATOMIC_RELEASE);
+}
+
+// Records the node just linked in at *link
+static void index_linked(List* list, Node** link) {
+    struct ListIndex* index = list->index;
+    Node* node = *link;
+    Node* next = node->next;
+
+    // The successor's link moved from *link to node->next
+    if (next != NULL && index->first[next->data] == link) {
+        set_first(index, next->data, &node->next);
+    }
+
+    uint16_t value = node->data;
+    if (index->count[value]++ == 0 || index->first[value] == &node->next) {
+        set_first(index, value, link);
+    } else if (next != NULL) {
+        // A duplicate inserted in the middle: whichever occurrence comes first wins
+        Node** current = &list->head;
+        while (current != index->first[value] && *current != node) {
+            current = &(*current)->next;
+        }
+        set_first(index, value, current);
+    }
+}
+
+// Records that node was just unlinked from *link
+static void index_unlinked(List* list, Node** link, Node* node) {
+    struct ListIndex* index = list->index;
+    uint16_t value = node->data;
+    int was_first = index->first[value] == link;
+    Node* next = *link;
+
+    if (next != NULL && index->first[next->data] == &node->next) {
+        set_first(index, next->data, link);
+    }
+
+    if (--index->count[value] == 0) {
+        set_first(index, value, NULL);
+    } else if (was_first) {
+        // Every earlier node differs, so the next occurrence is the new first one
+        Node** current = link;
+        while ((*current)->data != value) {
+            current = &(*current)->next;
+        }
+        set_first(index, value, current);
+    }
+}
+
+// Fills an index that readers cannot see
+static void index_rebuild(List* list, struct ListIndex* index) {
+    memset(index, 0, sizeof(*index));
+    for (Node** link = &list->head; *link != NULL; link = &(*link)->next) {
+        if (index->count[(*link)->data]++ == 0) {
+            index->first[(*link)->data] = link;
+        }
+    }
+}
+
+// Replaces the index after the nodes were reordered. The new index is built in a
+// fresh block and published with one store, so readers see either the old or the
+// new one, and the old one is returned to be freed once no reader can be on it.
+// Without room for a second index, readers scan while the index is rebuilt in
+// place. Must not be called from inside a read section.
+static struct ListIndex* index_replace(List* list) {
+    struct ListIndex* old = list->index;
+    if (old == NULL) {
+        return NULL;
+    }
+
+    struct ListIndex* index = (struct ListIndex*)mem_alloc(sizeof(struct ListIndex));
+    if (index == NULL) {
+        __atomic_store_n(&list->index, NULL, __ATOMIC_RELEASE);
+        epoch_synchronize();
+        index = old;
+        old = NULL;
+    }
+    index_rebuild(list, index);
+    __atomic_store_n(&list->index, index, __ATOMIC_RELEASE);
+    return old;
+}
+
+// ********* Sorted mode structures *********
+// In sorted mode a skip list is layered over the nodes. The node list itself is
+// level 0; a node promoted to higher levels owns a tower, allocated from the pool,
+// whose next[l] links the towers of level l + 1 in value order. Unlinked towers are
+// retired and reclaimed together with the node batch of their node. Towers are
+// carved from arenas reserved from the pool and recycled through one freelist per
+// height, so they cost no first-fit search of the pool.
+
+#define SKIP_MAX_LEVEL 16
+#define SKIP_ARENA_BYTES 4096 // Pool bytes reserved per tower arena when there is room
+
+typedef struct SkipTower {
+    Node* node;
+    struct SkipTower* retired; // Next tower in the same retired batch
+    int height;
+    struct SkipTower* next[];
+} SkipTower;
+
+typedef struct TowerArena {
+    char* memory;
+    struct TowerArena* next;
+} TowerArena;
+
+struct SkipList {
+    SkipTower* head[SKIP_MAX_LEVEL];
+    uint32_t rng;       // Xorshift state for tower heights
+    SkipTower* retired; // Towers unlinked with the nodes in list->retired
+    SkipTower* sealed;  // Towers unlinked with the nodes in list->sealed
+    SkipTower* free_towers[SKIP_MAX_LEVEL + 1]; // Recycled towers by height, linked through retired
+    TowerArena* arenas;
+    char* arena_next;   // Unused space in the newest arena
+    size_t arena_left;
+};
+
+static inline SkipTower* load_tower(SkipTower** link) {
+    return __atomic_load_n(link, __ATOMIC_ACQUIRE);
+}
+
+static inline size_t tower_size(int height) {
+    return (sizeof(SkipTower) + height * sizeof(SkipTower*) + 7) & ~(size_t)7;
+}
+
+static SkipTower* alloc_tower(struct SkipList* skip, int height) {
+    SkipTower* tower = skip->free_towers[height];
+    if (tower != NULL) {
+        skip->free_towers[height] = tower->retired;
+        return tower;
+    }
+
+    size_t size = tower_size(height);
+    if (skip->arena_left < size) {
+        TowerArena* arena = (TowerArena*)malloc(sizeof(TowerArena));
+        if (!arena) {
+            return NULL;
+        }
+        size_t bytes = SKIP_ARENA_BYTES;
+        while ((arena->memory = (char*)mem_alloc(bytes)) == NULL && bytes / 2 >= size) {
+            bytes /= 2;
+        }
+        if (arena->memory == NULL) {
+            free(arena);
+            return NULL;
+        }
+        arena->next = skip->arenas;
+        skip->arenas = arena;
+        skip->arena_next = arena->memory;
+        skip->arena_left = bytes;
+    }
+
+    tower = (SkipTower*)skip->arena_next;
+    skip->arena_next += size;
+    skip->arena_left -= size;
+    return tower;
+}
+
+static void free_towers(struct SkipList* skip, SkipTower* tower) {
+    while (tower != NULL) {
+        SkipTower* next = tower->retired;
+        tower->retired = skip->free_towers[tower->height];
+        skip->free_towers[tower->height] = tower;
+        tower = next;
+    }
+}
+
+// ********* Node freelist (caller holds the list lock) *********
+// Nodes are reserved from the pool in chunks and recycled through a per-list
+// freelist, so inserts and deletes only call into the memory manager when the
+// freelist runs dry. The chunks go back to the pool when the list is destroyed.
+
+#define LIST_NODE_CHUNK 64 // Nodes reserved per chunk when the pool has room
+#define LIST_CHECKPOINT_STRIDE 64 // Positions between cached nodes for positional seeks
+
+typedef struct NodeChunk {
+    Node* nodes;
+    size_t count; // Nodes in the chunk
+    struct NodeChunk* next;
+} NodeChunk;
+
+// Reserves a chunk of up to count nodes, halving the chunk until it fits in the pool
+static int reserve_nodes(List* list, size_t count) {
+    NodeChunk* chunk = (NodeChunk*)malloc(sizeof(NodeChunk));
+    if (!chunk) {
+        return 0;
+    }
 
-    Node* new_node = (Node*)mem_alloc(sizeof(Node));
-    if (!new_node) {
+    chunk->nodes = NULL;
+    while (count > 0 && (chunk->nodes = (Node*)mem_alloc(count * sizeof(Node))) == NULL) {
+        count /= 2;
+    }
+    if (chunk->nodes == NULL) {
+        free(chunk);
+        return 0;
+    }
+
+    // Push the nodes from the back, so appends take them in address order
+    for (size_t i = count; i-- > 0;) {
+        chunk->nodes[i].next = list->free_nodes;
+        list->free_nodes = &chunk->nodes[i];
+    }
+    chunk->count = count;
+    chunk->next = list->chunks;
+    list->chunks = chunk;
+    return 1;
+}
+
+static void release_node(List* list, Node* node) {
+    node->next = list->free_nodes;
+    list->free_nodes = node;
+}
+
+static void release_chunks(List* list) {
+    NodeChunk* chunk = list->chunks;
+    while (chunk != NULL) {
+        NodeChunk* next = chunk->next;
+        mem_free(chunk->nodes);
+        free(chunk);
+        chunk = next;
+    }
+    list->chunks = NULL;
+    list->free_nodes = NULL;
+    list->retired = NULL;
+    list->sealed = NULL;
+    list->retired_count = 0;
+}
+
+// ********* Deferred node reuse (caller holds the list lock) *********
+// An unlinked node keeps its next pointer so that readers standing on it can move
+// on. It is retired into the open batch, chained through prev (which readers never
+// follow). Reclaiming seals the open batch with the epoch stamp of its last node,
+// and a sealed batch returns to the freelist once no reader can still hold it.
+
+#define LIST_RETIRE_BATCH 64 // Retired nodes between two reclaim attempts
+
+static void release_batch(List* list, Node* batch) {
+    while (batch != NULL) {
+        Node* next = batch->prev;
+        release_node(list, batch);
+        batch = next;
+    }
+}
+
+static void reclaim_locked(List* list) {
+    for (int pass = 0; pass < 2; pass++) {
+        if (list->sealed == NULL) {
+            list->sealed = list->retired;
+            list->sealed_stamp = list->retired_stamp;
+            list->retired = NULL;
+            list->retired_count = 0;
+            if (list->skip) {
+                list->skip->sealed = list->skip->retired;
+                list->skip->retired = NULL;
+            }
+        }
+        if (list->sealed == NULL || list->sealed_stamp >= epoch_reclaim_bound()) {
+            return;
+        }
+        release_batch(list, list->sealed);
+        list->sealed = NULL;
+        if (list->skip) {
+            free_towers(list->skip, list->skip->sealed);
+            list->skip->sealed = NULL;
+        }
+    }
+}
+
+static void retire_node(List* list, Node* node) {
+    node->prev = list->retired;
+    list->retired = node;
+    list->retired_stamp = epoch_stamp();
+    if (++list->retired_count >= LIST_RETIRE_BATCH) {
+        reclaim_locked(list);
+    }
+}
+
+// Makes sure the freelist is not empty: recycles retired nodes, then reserves a
+// chunk of up to count nodes, and when the pool is full waits for the readers
+// that keep retired nodes from being reused
+static int refill_nodes(List* list, size_t count) {
+    reclaim_locked(list);
+    if (list->free_nodes != NULL || reserve_nodes(list, count)) {
+        return 1;
+    }
+
+    if (list->retired != NULL || list->sealed != NULL) {
+        epoch_synchronize();
+        release_batch(list, list->sealed);
+        release_batch(list, list->retired);
+        list->sealed = NULL;
+        list->retired = NULL;
+        list->retired_count = 0;
+        if (list->skip) {
+            free_towers(list->skip, list->skip->sealed);
+            free_towers(list->skip, list->skip->retired);
+            list->skip->sealed = NULL;
+            list->skip->retired = NULL;
+        }
+    }
+    return list->free_nodes != NULL;
+}
+
+// ********* List handle operations (caller holds the list lock) *********
+
+static Node* new_node(List* list, uint16_t data) {
+    if (list->free_nodes == NULL && !refill_nodes(list, LIST_NODE_CHUNK)) {
         printf("Memory allocation failed\n");
-        pthread_mutex_unlock(&list_mutex);
+        return NULL;
+    }
+    Node* node = list->free_nodes;
+    list->free_nodes = node->next;
+    node->data = data;
+    node->next = NULL;
+    node->prev = NULL;
+    return node;
+}
+
+// Returns the link that points at node
+static inline Node** link_to(List* list, Node* node) {
+    return node->prev ? &node->prev->next : &list->head;
+}
+
+// ********* Positional checkpoints (caller holds the list lock) *********
+// checkpoints[0] is the head and checkpoints[c] for c > 0 caches the node at position
+// c * LIST_CHECKPOINT_STRIDE + checkpoint_offset, where the offset stays within one
+// stride of zero. Each cached node records its slot, so an edit finds the closest
+// checkpoint before it within 2 * LIST_CHECKPOINT_STRIDE steps back and drops only
+// the checkpoints after that one. Appends touch nothing, and an edit before
+// checkpoint 1, such as a push or pop at the head, just moves the offset. The next
+// seek extends the cache again from the last valid checkpoint; once built, a seek
+// is one array lookup plus fewer than 2 * LIST_CHECKPOINT_STRIDE steps.
+
+static inline void set_checkpoint(List* list, size_t slot, Node* node) {
+    list->checkpoints[slot] = node;
+    node->checkpoint = (uint32_t)slot + list->checkpoint_base;
+}
+
+// Position of the node cached in checkpoints[slot]
+static inline size_t checkpoint_position(List* list, size_t slot) {
+    if (slot == 0) {
+        return 0;
+    }
+    return (size_t)((long)(slot * LIST_CHECKPOINT_STRIDE) + list->checkpoint_offset);
+}
+
+static int grow_checkpoints(List* list, size_t slots) {
+    if (slots <= list->checkpoint_capacity) {
+        return 1;
+    }
+    size_t capacity = list->checkpoint_capacity ? list->checkpoint_capacity : 16;
+    while (capacity < slots) {
+        capacity *= 2;
+    }
+    Node** grown = (Node**)realloc(list->checkpoints, capacity * sizeof(Node*));
+    if (grown == NULL) {
+        return 0;
+    }
+    list->checkpoints = grown;
+    list->checkpoint_capacity = capacity;
+    return 1;
+}
+
+// Updates the checkpoints after a node was linked in right after prev (delta 1) or
+// removed was unlinked from there (delta -1); prev is NULL at the head.
+static void checkpoints_edited(List* list, Node* prev, Node* removed, int delta) {
+    if (list->checkpoints_valid == 0) {
+        return;
+    }
+    if (list->head == NULL) {
+        list->checkpoints_valid = 0;
         return;
     }
+    set_checkpoint(list, 0, list->head);
 
-    new_node->data = data;
-    new_node->next = NULL;
+    // A walk that finds no checkpoint is past the last valid one
+    size_t slot = 0;
+    int steps = 0;
+    for (Node* node = prev; node != NULL; node = node->prev) {
+        if (++steps > 2 * LIST_CHECKPOINT_STRIDE) {
+            return;
+        }
+        uint32_t found = node->checkpoint - list->checkpoint_base;
+        if (found < list->checkpoints_valid && list->checkpoints[found] == node) {
+            slot = found;
+            break;
+        }
+    }
+    if (slot > 0) {
+        list->checkpoints_valid = slot + 1; // The later checkpoints moved
+        return;
+    }
+    if (list->checkpoints_valid == 1) {
+        list->checkpoint_offset = 0;
+        return;
+    }
 
-    if (*head == NULL) {
-        *head = new_node;
+    // Every checkpoint after the head moves by delta
+    if (removed == list->checkpoints[1]) {
+        set_checkpoint(list, 1, prev); // Now at the position the offset gives
+    }
+    list->checkpoint_offset += delta;
+    if (list->checkpoint_offset == -LIST_CHECKPOINT_STRIDE) {
+        // Checkpoint 1 is the head now; the others move down a slot
+        memmove(&list->checkpoints[1], &list->checkpoints[2], (list->checkpoints_valid - 2) * sizeof(Node*));
+        list->checkpoints_valid--;
+        list->checkpoint_base++;
+        list->checkpoint_offset = 0;
+        set_checkpoint(list, 0, list->head);
+    } else if (list->checkpoint_offset == LIST_CHECKPOINT_STRIDE) {
+        // A new checkpoint fits between the head and checkpoint 1
+        if (!grow_checkpoints(list, list->checkpoints_valid + 1)) {
+            list->checkpoints_valid = 1;
+            list->checkpoint_offset = 0;
+            return;
+        }
+        memmove(&list->checkpoints[2], &list->checkpoints[1], (list->checkpoints_valid - 1) * sizeof(Node*));
+        list->checkpoints_valid++;
+        list->checkpoint_base--;
+        list->checkpoint_offset = 0;
+        set_checkpoint(list, 0, list->head);
+        Node* node = list->head;
+        for (int step = 0; step < LIST_CHECKPOINT_STRIDE; step++) {
+            node = node->next;
+        }
+        set_checkpoint(list, 1, node);
+    }
+}
+
+// Links a new node right after prev, or at the head when prev is NULL
+static Node* link_after_locked(List* list, Node* prev, uint16_t data) {
+    Node* node = new_node(list, data);
+    if (!node) {
+        return NULL;
+    }
+
+    Node** link = prev ? &prev->next : &list->head;
+    node->next = *link;
+    node->prev = prev;
+    publish_link(link, node);
+    if (node->next) {
+        node->next->prev = node;
+        checkpoints_edited(list, prev, NULL, 1);
     } else {
-        Node* current = *head;
-        while (current->next != NULL) {
-            current = current->next;
+        list->tail = node;
+        if (prev == NULL) {
+            checkpoints_edited(list, prev, NULL, 1);
         }
-        current->next = new_node;
     }
+    set_count(list, list->count + 1);
+    if (list->index) {
+        index_linked(list, link);
+    }
+    return node;
+}
 
-    pthread_mutex_unlock(&list_mutex);
+static Node* insert_sorted_locked(List* list, uint16_t data);
+
+static void append_locked(List* list, uint16_t data) {
+    if (list->skip) {
+        insert_sorted_locked(list, data);
+    } else {
+        link_after_locked(list, list->tail, data);
+    }
 }
 
+// Appends the values in order; when the freelist runs dry the rest of the values
+// are reserved with one allocation. Returns the number of values appended.
+static size_t append_many_locked(List* list, const uint16_t* values, size_t count) {
+    size_t added = 0;
+    while (added < count) {
+        if (list->free_nodes == NULL && !refill_nodes(list, count - added)) {
+            printf("Memory allocation failed\n");
+            break;
+        }
+        if (list->skip) {
+            insert_sorted_locked(list, values[added++]);
+        } else {
+            link_after_locked(list, list->tail, values[added++]);
+        }
+    }
+    return added;
+}
 
-// Deletes the first node with the specified data
-void list_delete(Node** head, uint16_t data) {
-    pthread_mutex_lock(&list_mutex); // Lock for thread safety
+static void add_after_locked(List* list, Node* prev_node, uint16_t data) {
+    link_after_locked(list, prev_node, data);
+}
 
-    if (*head == NULL) {
-        printf("List is empty\n");
-        pthread_mutex_unlock(&list_mutex);
+static void add_before_locked(List* list, Node* next_node, uint16_t data) {
+    if (list->head == NULL || next_node == NULL) {
+        printf("Cannot insert before a NULL node\n");
         return;
     }
+    link_after_locked(list, next_node->prev, data);
+}
+
+static void skip_unlinked(List* list, Node* node);
+
+static void unlink_locked(List* list, Node* node) {
+    if (list->skip) {
+        skip_unlinked(list, node);
+    }
 
-    Node* current = *head;
-    Node* previous = NULL;
+    Node** link = link_to(list, node);
+    publish_link(link, node->next);
+    if (node->next) {
+        node->next->prev = node->prev;
+    } else {
+        list->tail = node->prev;
+    }
+    checkpoints_edited(list, node->prev, node, -1);
+    set_count(list, list->count - 1);
+    if (list->index) {
+        index_unlinked(list, link, node);
+    }
+
+    retire_node(list, node);
+}
+
+// ********* Positional seek (caller holds the list lock) *********
+
+static Node* seek_locked(List* list, size_t index) {
+    if (index >= list->count) {
+        return NULL;
+    }
+
+    if (list->checkpoints_valid == 0) {
+        list->checkpoint_offset = 0;
+    }
+    // Last checkpoint at or before index
+    size_t first = checkpoint_position(list, 1);
+    size_t wanted = index < first ? 0 : 1 + (index - first) / LIST_CHECKPOINT_STRIDE;
+    if (!grow_checkpoints(list, wanted + 1)) {
+        // No cache; fall back to walking from the head
+        Node* node = list->head;
+        while (index-- > 0) {
+            node = node->next;
+        }
+        return node;
+    }
+
+    if (list->checkpoints_valid == 0) {
+        set_checkpoint(list, 0, list->head);
+        list->checkpoints_valid = 1;
+    }
+    while (list->checkpoints_valid <= wanted) {
+        size_t slot = list->checkpoints_valid;
+        Node* node = list->checkpoints[slot - 1];
+        for (size_t position = checkpoint_position(list, slot - 1); position < checkpoint_position(list, slot); position++) {
+            node = node->next;
+        }
+        set_checkpoint(list, slot, node);
+        list->checkpoints_valid++;
+    }
+
+    Node* node = list->checkpoints[wanted];
+    for (size_t position = checkpoint_position(list, wanted); position < index; position++) {
+        node = node->next;
+    }
+    return node;
+}
+
+// ********* Sorted mode operations *********
+
+// Descends from the top level and returns the node of the last tower whose value
+// is below data (or not above it when inclusive), NULL if there is none. When
+// update is given, update[l] receives the level l link that follows that position.
+// Safe for readers in an epoch read section.
+static Node* skip_descend(struct SkipList* skip, uint16_t data, int inclusive, SkipTower*** update) {
+    SkipTower** links = skip->head;
+    Node* start = NULL;
+    for (int level = SKIP_MAX_LEVEL - 1; level >= 0; level--) {
+        SkipTower* next;
+        Node* node;
+        // Compaction moves the node of a tower, so load it once per step
+        while ((next = load_tower(&links[level])) != NULL &&
+               ((node = __atomic_load_n(&next->node, __ATOMIC_ACQUIRE))->data < data ||
+                (inclusive && node->data == data))) {
+            links = next->next;
+            start = node;
+        }
+        if (update) {
+            update[level] = &links[level];
+        }
+    }
+    return start;
+}
+
+// Returns the first node whose value is not below data
+static Node* skip_seek(List* list, struct SkipList* skip, uint16_t data) {
+    Node* current = skip_descend(skip, data, 0, NULL);
+    current = current ? current : load_link(&list->head);
+    while (current != NULL && current->data < data) {
+        current = load_link(&current->next);
+    }
+    return current;
+}
+
+// Tower height 0 with probability 3/4, then each extra level with probability 1/4
+static int skip_random_height(struct SkipList* skip) {
+    uint32_t x = skip->rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    skip->rng = x;
+
+    int height = 0;
+    while (height < SKIP_MAX_LEVEL && (x & 3) == 0) {
+        height++;
+        x >>= 2;
+    }
+    return height;
+}
+
+// Gives node a tower linked in after the given links. A tower that does not fit in
+// the pool is skipped; the node is still found through the level below.
+static void skip_add_tower(struct SkipList* skip, Node* node, SkipTower** update[]) {
+    int height = skip_random_height(skip);
+    if (height == 0) {
+        return;
+    }
+
+    SkipTower* tower = alloc_tower(skip, height);
+    if (!tower) {
+        return;
+    }
+    tower->node = node;
+    tower->retired = NULL;
+    tower->height = height;
+    for (int level = 0; level < height; level++) {
+        tower->next[level] = *update[level];
+        __atomic_store_n(update[level], tower, __ATOMIC_RELEASE);
+    }
+}
+
+// Inserts after the last node whose value is not above data
+static Node* insert_sorted_locked(List* list, uint16_t data) {
+    struct SkipList* skip = list->skip;
+    SkipTower** update[SKIP_MAX_LEVEL];
+    Node* prev = skip_descend(skip, data, 1, update);
+
+    Node* next = prev ? prev->next : list->head;
+    while (next != NULL && next->data <= data) {
+        prev = next;
+        next = next->next;
+    }
+
+    Node* node = link_after_locked(list, prev, data);
+    if (node) {
+        skip_add_tower(skip, node, update);
+    }
+    return node;
+}
+
+// Unlinks the tower of a node about to be removed, if it has one
+static void skip_unlinked(List* list, Node* node) {
+    struct SkipList* skip = list->skip;
+    SkipTower** update[SKIP_MAX_LEVEL];
+    skip_descend(skip, node->data, 0, update);
+
+    SkipTower* tower = NULL;
+    for (int level = 0; level < SKIP_MAX_LEVEL; level++) {
+        // Towers of equal values follow the descent position; find this node's
+        SkipTower** link = update[level];
+        while (*link != NULL && (*link)->node != node && (*link)->node->data == node->data) {
+            link = &(*link)->next[level];
+        }
+        if (*link == NULL || (*link)->node != node) {
+            break;
+        }
+        tower = *link;
+        __atomic_store_n(link, tower->next[level], __ATOMIC_RELEASE);
+    }
+
+    if (tower) {
+        tower->retired = skip->retired;
+        skip->retired = tower;
+    }
+}
 
+// Builds towers for the nodes of an already sorted list
+static void skip_build(List* list, struct SkipList* skip) {
+    SkipTower** update[SKIP_MAX_LEVEL];
+    for (int level = 0; level < SKIP_MAX_LEVEL; level++) {
+        skip->head[level] = NULL;
+        update[level] = &skip->head[level];
+    }
+
+    for (Node* node = list->head; node != NULL; node = node->next) {
+        skip_add_tower(skip, node, update);
+        SkipTower* tower = *update[0] && (*update[0])->node == node ? *update[0] : NULL;
+        for (int level = 0; tower != NULL && level < tower->height; level++) {
+            update[level] = &tower->next[level];
+        }
+    }
+}
+
+// ********* Read paths (the list lock or an epoch read section) *********
+
+static Node* scan_from(Node* current, uint16_t data) {
     while (current != NULL && current->data != data) {
-        previous = current;
-        current = current->next;
+        current = load_link(&current->next);
+    }
+    return current;
+}
+
+static Node* find_locked(List* list, uint16_t data) {
+    struct ListIndex* index = __atomic_load_n(&list->index, __ATOMIC_ACQUIRE);
+    if (index) {
+        Node** link = __atomic_load_n(&index->first[data], __ATOMIC_ACQUIRE);
+        Node* node = link ? load_link(link) : NULL;
+        // A reader may see an entry a writer is moving; only trust it if it checks out
+        if (link == NULL || (node != NULL && node->data == data)) {
+            return node;
+        }
+    }
+
+    struct SkipList* skip = __atomic_load_n(&list->skip, __ATOMIC_ACQUIRE);
+    if (skip) {
+        Node* node = skip_seek(list, skip, data);
+        return node != NULL && node->data == data ? node : NULL;
+    }
+    return scan_from(load_link(&list->head), data);
+}
+
+static void remove_locked(List* list, uint16_t data) {
+    if (list->head == NULL) {
+        printf("List is empty\n");
+        return;
     }
 
+    Node* current = find_locked(list, data);
     if (current == NULL) {
         printf("Data not found in the list\n");
-        pthread_mutex_unlock(&list_mutex);
         return;
     }
+    unlink_locked(list, current);
+}
 
-    if (previous == NULL) {
-        *head = current->next;
-    } else {
-        previous->next = current->next;
+// ********* Display *********
+// Displays copy the values out inside a read section, then format them into one
+// buffer and hand it to stdio in a single write, so no lock or read section is
+// held while the text is produced.
+
+#define LIST_VALUE_CHARS 7 // ", 65535"
+
+// Copies the values from start_node (or first) up to end_node inclusive into a
+// malloc'd array. Returns NULL if memory runs out. Caller must be in a read section.
+static uint16_t* snapshot_range(Node* first, Node* start_node, Node* end_node, size_t hint, size_t* count) {
+    size_t capacity = hint ? hint : 64;
+    uint16_t* values = (uint16_t*)malloc(capacity * sizeof(uint16_t));
+    *count = 0;
+
+    for (Node* current = start_node ? start_node : first; current != NULL && values != NULL;
+         current = load_link(&current->next)) {
+        if (*count == capacity) {
+            capacity *= 2;
+            uint16_t* grown = (uint16_t*)realloc(values, capacity * sizeof(uint16_t));
+            if (grown == NULL) {
+                free(values);
+                return NULL;
+            }
+            values = grown;
+        }
+        values[(*count)++] = current->data;
+        if (current == end_node) {
+            break;
+        }
     }
+    return values;
+}
 
-    mem_free(current);
+// Writes "[a, b, c]" into buf, which must hold count * LIST_VALUE_CHARS + 3 bytes.
+// Returns the length without the terminating NUL.
+static size_t format_values(const uint16_t* values, size_t count, char* buf) {
+    char* out = buf;
+    *out++ = '[';
+    for (size_t i = 0; i < count; i++) {
+        if (i > 0) {
+            *out++ = ',';
+            *out++ = ' ';
+        }
+        char digits[5];
+        int n = 0;
+        unsigned value = values[i];
+        do {
+            digits[n++] = (char)('0' + value % 10);
+            value /= 10;
+        } while (value != 0);
+        while (n > 0) {
+            *out++ = digits[--n];
+        }
+    }
+    *out++ = ']';
+    *out = '\0';
+    return (size_t)(out - buf);
+}
+
+// Formats a snapshot of the range into a malloc'd string, or returns NULL
+static char* format_range(Node** first, Node* start_node, Node* end_node, size_t hint, size_t* length) {
+    size_t count;
+    epoch_enter();
+    uint16_t* values = snapshot_range(load_link(first), start_node, end_node, hint, &count);
+    epoch_exit();
+    if (values == NULL) {
+        return NULL;
+    }
 
-    pthread_mutex_unlock(&list_mutex); // Unlock after operation
+    char* text = (char*)malloc(count * LIST_VALUE_CHARS + 3);
+    if (text != NULL) {
+        *length = format_values(values, count, text);
+    }
+    free(values);
+    return text;
 }
 
+static void print_range(Node** first, Node* start_node, Node* end_node, size_t hint, const char* suffix) {
+    size_t length;
+    char* text = format_range(first, start_node, end_node, hint, &length);
+    if (text == NULL) {
+        printf("Memory allocation failed\n");
+        return;
+    }
+    fwrite(text, 1, length, stdout);
+    fputs(suffix, stdout);
+    free(text);
+}
 
-// Searches for a node with the specified data
-Node* list_search(Node** head, uint16_t data) {
-    pthread_mutex_lock(&list_mutex); // Lock for thread safety
+// ********* Sorting (caller holds the list lock) *********
+// The sorts relink the existing nodes and never allocate pool memory. They work
+// on NULL-terminated chains linked through next only, and finish_sort restores
+// head, tail, prev pointers, positions and the index in one pass. Links are
+// published as they change, so readers running during a sort never reach a freed
+// node, but they may see part of the list or some nodes twice. All sorts are
+// stable.
+
+#define LIST_SORT_BINS 64 // Bin i holds a sorted run of 2^i nodes; enough for any size_t
+#define LIST_SORT_MIN_SEGMENT 4096 // Smallest segment worth a worker thread
 
-    Node* current = *head;
-    while (current != NULL) {
-        if (current->data == data) {
-            pthread_mutex_unlock(&list_mutex);
-            return current;
+// Merges two sorted chains; on equal values the node from a comes first
+static Node* merge_chains(Node* a, Node* b) {
+    Node* merged = NULL;
+    Node** link = &merged;
+    while (a != NULL && b != NULL) {
+        if (a->data <= b->data) {
+            publish_link(link, a);
+            link = &a->next;
+            a = a->next;
+        } else {
+            publish_link(link, b);
+            link = &b->next;
+            b = b->next;
         }
-        current = current->next;
     }
+    publish_link(link, a != NULL ? a : b);
+    return merged;
+}
 
-    pthread_mutex_unlock(&list_mutex); // Unlock if not found
+// Bottom-up merge sort: every node is merged into the bins like a binary counter
+// is incremented, so no recursion or list lengths are needed
+static Node* merge_sort_chain(Node* chain) {
+    Node* bins[LIST_SORT_BINS] = {NULL};
+    int used = 0;
+    while (chain != NULL) {
+        Node* run = chain;
+        chain = chain->next;
+        publish_link(&run->next, NULL);
+
+        int bin = 0;
+        for (; bin < used && bins[bin] != NULL; bin++) {
+            run = merge_chains(bins[bin], run);
+            bins[bin] = NULL;
+        }
+        if (bin == used) {
+            used++;
+        }
+        bins[bin] = run;
+    }
+
+    Node* sorted = NULL;
+    for (int bin = 0; bin < used; bin++) {
+        sorted = merge_chains(bins[bin], sorted); // Higher bins hold earlier nodes
+    }
+    return sorted;
+}
+
+// LSD radix sort on the low then the high byte, relinking the chain into 256
+// buckets per pass
+static Node* radix_sort_chain(Node* chain) {
+    for (int shift = 0; shift < 16; shift += 8) {
+        Node* heads[256] = {NULL};
+        Node** links[256];
+        for (int bucket = 0; bucket < 256; bucket++) {
+            links[bucket] = &heads[bucket];
+        }
+
+        for (Node* node = chain; node != NULL; node = node->next) {
+            int bucket = (node->data >> shift) & 0xFF;
+            publish_link(links[bucket], node);
+            links[bucket] = &node->next;
+        }
+
+        Node** link = &chain;
+        for (int bucket = 0; bucket < 256; bucket++) {
+            if (heads[bucket] != NULL) {
+                publish_link(link, heads[bucket]);
+                link = links[bucket];
+            }
+        }
+        publish_link(link, NULL);
+    }
+    return chain;
+}
+
+typedef struct SortSegment {
+    Node* chain;
+    Node* other; // Second chain when merging
+    pthread_t thread;
+} SortSegment;
+
+static void* sort_segment_thread(void* arg) {
+    SortSegment* segment = (SortSegment*)arg;
+    segment->chain = merge_sort_chain(segment->chain);
     return NULL;
 }
 
+static void* merge_segment_thread(void* arg) {
+    SortSegment* segment = (SortSegment*)arg;
+    segment->chain = merge_chains(segment->chain, segment->other);
+    return NULL;
+}
 
-// Inserts a new node after a given node
-void list_insert_after(Node* prev_node, uint16_t data) {
+// Runs job on every stride-th segment, each on its own thread except the first,
+// which the caller takes along with any whose thread fails to start
+static void run_segments(SortSegment* segments, int num_segments, int stride, void* (*job)(void*)) {
+    int started[num_segments];
+    for (int i = stride; i < num_segments; i += stride) {
+        started[i] = pthread_create(&segments[i].thread, NULL, job, &segments[i]) == 0;
+    }
+    job(&segments[0]);
+    for (int i = stride; i < num_segments; i += stride) {
+        if (started[i]) {
+            pthread_join(segments[i].thread, NULL);
+        } else {
+            job(&segments[i]);
+        }
+    }
+}
+
+// Cuts the chain into num_segments chains of about equal length, sorts them on
+// worker threads (the calling thread takes the first one) and merges neighbours
+// pairwise in parallel until one chain is left
+static Node* parallel_sort_chain(Node* chain, size_t count, int num_segments) {
+    SortSegment segments[num_segments];
+    size_t length = (count + num_segments - 1) / num_segments;
+    for (int i = 0; i < num_segments; i++) {
+        segments[i].chain = chain;
+        for (size_t k = 1; chain != NULL && k < length; k++) {
+            chain = chain->next;
+        }
+        if (chain != NULL) {
+            Node* rest = chain->next;
+            publish_link(&chain->next, NULL);
+            chain = rest;
+        }
+    }
+
+    run_segments(segments, num_segments, 1, sort_segment_thread);
+    for (int step = 1; step < num_segments; step *= 2) {
+        for (int i = 0; i < num_segments; i += 2 * step) {
+            segments[i].other = i + step < num_segments ? segments[i + step].chain : NULL;
+        }
+        run_segments(segments, num_segments, 2 * step, merge_segment_thread);
+    }
+    return segments[0].chain;
+}
+
+// Publishes a sorted chain as the list and rebuilds what depends on node order
+static void finish_sort(List* list, Node* chain) {
+    publish_link(&list->head, chain);
+    Node* previous = NULL;
+    for (Node* current = chain; current != NULL; current = current->next) {
+        current->prev = previous;
+        previous = current;
+    }
+    list->tail = previous;
+    list->checkpoints_valid = 0;
+    struct ListIndex* old_index = index_replace(list);
+    if (old_index) {
+        epoch_synchronize();
+        mem_free(old_index);
+    }
+}
+
+// ********* Compaction (caller holds the list lock) *********
+// Churn leaves consecutive nodes scattered over the chunks. Compaction copies the
+// nodes in list order into new chunks, as large as the pool allows, so a traversal
+// walks memory sequentially. The old nodes are left intact for readers still on
+// them and the old chunks are released after a grace period.
+
+// Reserves chunks holding count nodes in total, in order, halving the chunk size
+// while the pool has no room. Returns NULL if even LIST_NODE_CHUNK nodes do not fit.
+static NodeChunk* reserve_run(size_t count) {
+    NodeChunk* first = NULL;
+    NodeChunk** link = &first;
+    size_t size = count;
+    while (count > 0) {
+        if (size > count) {
+            size = count;
+        }
+        NodeChunk* chunk = (NodeChunk*)malloc(sizeof(NodeChunk));
+        Node* nodes = chunk ? (Node*)mem_alloc(size * sizeof(Node)) : NULL;
+        if (nodes == NULL && chunk != NULL && size > LIST_NODE_CHUNK) {
+            free(chunk);
+            size /= 2;
+            continue;
+        }
+        if (nodes == NULL) {
+            free(chunk);
+            while (first != NULL) {
+                NodeChunk* next = first->next;
+                mem_free(first->nodes);
+                free(first);
+                first = next;
+            }
+            return NULL;
+        }
+        chunk->nodes = nodes;
+        chunk->count = size;
+        chunk->next = NULL;
+        *link = chunk;
+        link = &chunk->next;
+        count -= size;
+    }
+    return first;
+}
+
+static int compact_locked(List* list) {
+    if (list->head == NULL) {
+        return 0;
+    }
+    NodeChunk* run = reserve_run(list->count);
+    if (run == NULL) {
+        printf("Memory allocation failed\n");
+        return -1;
+    }
+
+    // Copy the nodes in list order; nothing is visible to readers yet
+    Node* first = NULL;
+    Node** link = &first;
+    Node* previous = NULL;
+    Node* old = list->head;
+    for (NodeChunk* chunk = run; chunk != NULL; chunk = chunk->next) {
+        for (size_t i = 0; i < chunk->count; i++, old = old->next) {
+            Node* node = &chunk->nodes[i];
+            node->data = old->data;
+            node->prev = previous;
+            *link = node;
+            link = &node->next;
+            previous = node;
+        }
+    }
+    *link = NULL;
+
+    // Point the towers at the copies; they are in list order along level 0
+    if (list->skip) {
+        SkipTower* tower = list->skip->head[0];
+        Node* copy = first;
+        for (old = list->head; old != NULL && tower != NULL; old = old->next, copy = copy->next) {
+            if (tower->node == old) {
+                __atomic_store_n(&tower->node, copy, __ATOMIC_RELEASE);
+                tower = tower->next[0];
+            }
+        }
+    }
+
+    publish_link(&list->head, first);
+    list->tail = previous;
+    list->checkpoints_valid = 0;
+    struct ListIndex* old_index = index_replace(list);
+
+    // Once no reader can be on the old nodes, their chunks, the retired towers and
+    // the old index go
+    epoch_synchronize();
+    mem_free(old_index);
+    if (list->skip) {
+        free_towers(list->skip, list->skip->sealed);
+        free_towers(list->skip, list->skip->retired);
+        list->skip->sealed = NULL;
+        list->skip->retired = NULL;
+    }
+    release_chunks(list);
+    list->chunks = run;
+    return 0;
+}
+
+// Removes every node and returns the node chunks to the pool. Sorted mode is
+// dropped and its towers are returned too. Must not run concurrently with readers.
+static void clear_locked(List* list) {
+    if (list->skip) {
+        // The pool may outlive the list, so hand the towers back as well
+        TowerArena* arena = list->skip->arenas;
+        while (arena != NULL) {
+            TowerArena* next = arena->next;
+            mem_free(arena->memory);
+            free(arena);
+            arena = next;
+        }
+        mem_free(list->skip);
+        list->skip = NULL;
+    }
+    free(list->checkpoints);
+    list->checkpoints = NULL;
+    list->checkpoint_capacity = 0;
+    list->checkpoints_valid = 0;
+    release_chunks(list);
+    list->head = NULL;
+    list->tail = NULL;
+    set_count(list, 0);
+    if (list->index) {
+        memset(list->index, 0, sizeof(*list->index));
+    }
+}
+
+// ********* List handle API *********
+
+static void reset_list(List* list) {
+    list->head = NULL;
+    list->tail = NULL;
+    list->count = 0;
+    list->index = NULL;
+    list->free_nodes = NULL;
+    list->chunks = NULL;
+    list->retired = NULL;
+    list->sealed = NULL;
+    list->retired_count = 0;
+    list->skip = NULL;
+    list->checkpoints = NULL;
+    list->checkpoint_capacity = 0;
+    list->checkpoints_valid = 0;
+    list->checkpoint_offset = 0;
+    list->checkpoint_base = 0;
+}
+
+void list_create(List* list, size_t size) {
+    reset_list(list);
+    pthread_mutex_init(&list->lock, NULL);
+    list->owns_pool = 1;
+    mem_init(size);
+}
+
+void list_create_shared(List* list) {
+    reset_list(list);
+    pthread_mutex_init(&list->lock, NULL);
+    list->owns_pool = 0;
+}
+
+void list_append(List* list, uint16_t data) {
+    pthread_mutex_lock(&list->lock);
+    append_locked(list, data);
+    pthread_mutex_unlock(&list->lock);
+}
+
+size_t list_insert_many(List* list, const uint16_t* values, size_t count) {
+    pthread_mutex_lock(&list->lock);
+    size_t added = append_many_locked(list, values, count);
+    pthread_mutex_unlock(&list->lock);
+    return added;
+}
+
+size_t list_from_array(List* list, size_t size, const uint16_t* values, size_t count) {
+    list_create(list, size);
+    return list_insert_many(list, values, count);
+}
+
+size_t list_to_array(List* list, uint16_t* out, size_t max) {
+    epoch_enter();
+    size_t written = 0;
+    for (Node* current = load_link(&list->head); current != NULL && written < max; current = load_link(&current->next)) {
+        out[written++] = current->data;
+    }
+    epoch_exit();
+    return written;
+}
+
+// ********* Snapshot files *********
+// A snapshot is a 16-byte header followed by the values in list order, in host
+// byte order, so a mapped file can be used as a uint16_t array directly.
+
+#define LIST_FILE_MAGIC "LLST"
+#define LIST_FILE_VERSION 1
+
+typedef struct ListFileHeader {
+    char magic[4];
+    uint32_t version; // Also tells the byte order apart
+    uint64_t count;   // Number of values that follow
+} ListFileHeader;
+
+// Flushes the directory holding path, so a rename into it survives a crash
+static int sync_directory(const char* path) {
+    const char* slash = strrchr(path, '/');
+    size_t length = slash == NULL ? 1 : slash == path ? 1 : (size_t)(slash - path);
+    char* dir = (char*)malloc(length + 1);
+    if (!dir) {
+        return -1;
+    }
+    memcpy(dir, slash == NULL ? "." : path, length);
+    dir[length] = '\0';
+    int fd = open(dir, O_RDONLY);
+    free(dir);
+    if (fd < 0) {
+        return -1;
+    }
+    int result = fsync(fd);
+    close(fd);
+    return result;
+}
+
+int list_save(List* list, const char* path) {
+    size_t count = list_length(list);
+    uint16_t* values = (uint16_t*)malloc(count * sizeof(uint16_t) + 1);
+    if (!values) {
+        printf("Memory allocation failed\n");
+        return -1;
+    }
+    count = list_to_array(list, values, count);
+
+    // Write next to the target, sync and rename, so a crash leaves either the old
+    // snapshot or the complete new one
+    size_t length = strlen(path);
+    char* temp = (char*)malloc(length + 5);
+    if (!temp) {
+        free(values);
+        printf("Memory allocation failed\n");
+        return -1;
+    }
+    memcpy(temp, path, length);
+    memcpy(temp + length, ".tmp", 5);
+
+    ListFileHeader header = {LIST_FILE_MAGIC, LIST_FILE_VERSION, count};
+    FILE* file = fopen(temp, "wb");
+    int ok = file != NULL &&
+             fwrite(&header, sizeof(header), 1, file) == 1 &&
+             fwrite(values, sizeof(uint16_t), count, file) == count &&
+             fflush(file) == 0 && fsync(fileno(file)) == 0;
+    ok = (file == NULL || fclose(file) == 0) && ok;
+    ok = ok && rename(temp, path) == 0 && sync_directory(path) == 0;
+    if (!ok) {
+        printf("Cannot write %s\n", path);
+        remove(temp);
+    }
+    free(temp);
+    free(values);
+    return ok ? 0 : -1;
+}
+
+int list_view_open(ListView* view, const char* path) {
+    view->values = NULL;
+    view->count = 0;
+    view->map = NULL;
+    view->map_size = 0;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        printf("Cannot open %s\n", path);
+        return -1;
+    }
+    struct stat st;
+    void* map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && (size_t)st.st_size >= sizeof(ListFileHeader)) {
+        map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd); // The mapping stays valid
+
+    const ListFileHeader* header = (const ListFileHeader*)map;
+    if (map == MAP_FAILED || memcmp(header->magic, LIST_FILE_MAGIC, 4) != 0 ||
+        header->version != LIST_FILE_VERSION ||
+        ((size_t)st.st_size - sizeof(ListFileHeader)) % sizeof(uint16_t) != 0 ||
+        header->count != ((size_t)st.st_size - sizeof(ListFileHeader)) / sizeof(uint16_t)) {
+        if (map != MAP_FAILED) {
+            munmap(map, st.st_size);
+        }
+        printf("Not a list snapshot: %s\n", path);
+        return -1;
+    }
+
+    view->values = (const uint16_t*)(header + 1);
+    view->count = header->count;
+    view->map = map;
+    view->map_size = st.st_size;
+    return 0;
+}
+
+void list_view_close(ListView* view) {
+    if (view->map) {
+        munmap(view->map, view->map_size);
+    }
+    view->values = NULL;
+    view->count = 0;
+    view->map = NULL;
+    view->map_size = 0;
+}
+
+int list_load(List* list, const char* path) {
+    ListView view;
+    if (list_view_open(&view, path) != 0) {
+        return -1;
+    }
+    madvise(view.map, view.map_size, MADV_SEQUENTIAL);
+    size_t added = list_insert_many(list, view.values, view.count);
+    size_t count = view.count;
+    list_view_close(&view);
+    return added == count ? 0 : -1;
+}
+
+// Positional inserts would break the order of a sorted list
+static int reject_positional(List* list) {
+    if (__atomic_load_n(&list->skip, __ATOMIC_ACQUIRE)) {
+        printf("Cannot insert at a position in a sorted list\n");
+        return 1;
+    }
+    return 0;
+}
+
+void list_add_after(List* list, Node* prev_node, uint16_t data) {
     if (!prev_node) {
         printf("Previous node cannot be NULL\n");
         return;
     }
+    if (reject_positional(list)) {
+        return;
+    }
 
-    pthread_mutex_lock(&list_mutex);
+    pthread_mutex_lock(&list->lock);
+    add_after_locked(list, prev_node, data);
+    pthread_mutex_unlock(&list->lock);
+}
 
-    Node* new_node = (Node*)mem_alloc(sizeof(Node));
-    if (!new_node) {
-        printf("Memory allocation failed\n");
-        pthread_mutex_unlock(&list_mutex);
+void list_add_before(List* list, Node* next_node, uint16_t data) {
+    if (reject_positional(list)) {
+        return;
+    }
+
+    pthread_mutex_lock(&list->lock);
+    add_before_locked(list, next_node, data);
+    pthread_mutex_unlock(&list->lock);
+}
+
+void list_remove(List* list, uint16_t data) {
+    pthread_mutex_lock(&list->lock);
+    remove_locked(list, data);
+    pthread_mutex_unlock(&list->lock);
+}
+
+void list_remove_node(List* list, Node* node) {
+    if (!node) {
+        printf("Cannot remove a NULL node\n");
         return;
     }
 
-    new_node->data = data;
-    new_node->next = prev_node->next;
-    prev_node->next = new_node;
+    pthread_mutex_lock(&list->lock);
+    unlink_locked(list, node);
+    pthread_mutex_unlock(&list->lock);
+}
+
+Node* list_find(List* list, uint16_t data) {
+    epoch_enter();
+    Node* node = find_locked(list, data);
+    epoch_exit();
+    return node;
+}
+
+void list_print(List* list) {
+    print_range(&list->head, NULL, NULL, list_length(list), "\n");
+}
 
-    pthread_mutex_unlock(&list_mutex);
+void list_print_range(List* list, Node* start_node, Node* end_node) {
+    print_range(&list->head, start_node, end_node, 0, "");
 }
 
+Node* list_at(List* list, size_t index) {
+    pthread_mutex_lock(&list->lock);
+    Node* node = seek_locked(list, index);
+    pthread_mutex_unlock(&list->lock);
+    return node;
+}
 
+void list_print_slice(List* list, size_t start, size_t end) {
+    if (start > end) {
+        printf("[]");
+        return;
+    }
 
-// Displays all elements in the list
-void list_display(Node** head) {
-    pthread_mutex_lock(&list_mutex); // Lock for thread safety
+    // The read section keeps the start node alive after the lock is dropped. It
+    // starts under the lock: writers holding the lock wait for read sections to end.
+    pthread_mutex_lock(&list->lock);
+    epoch_enter();
+    Node* first = seek_locked(list, start);
+    pthread_mutex_unlock(&list->lock);
 
-    Node* current = *head;
-    printf("[");
-    while (current != NULL) {
-        printf("%u", current->data);
-        if (current->next != NULL) {
-            printf(", ");
+    size_t count = 0;
+    size_t wanted = end - start + 1;
+    if (wanted > list_length(list)) {
+        wanted = list_length(list);
+    }
+    uint16_t* values = (uint16_t*)malloc(wanted * sizeof(uint16_t) + 1);
+    for (Node* current = first; current != NULL && values != NULL && count < wanted; current = load_link(&current->next)) {
+        values[count++] = current->data;
+    }
+    epoch_exit();
+
+    char* text = values ? (char*)malloc(count * LIST_VALUE_CHARS + 3) : NULL;
+    if (text == NULL) {
+        printf("Memory allocation failed\n");
+    } else {
+        fwrite(text, 1, format_values(values, count, text), stdout);
+    }
+    free(text);
+    free(values);
+}
+
+size_t list_format(List* list, char* buf, size_t n) {
+    size_t length;
+    char* text = format_range(&list->head, NULL, NULL, list_length(list), &length);
+    if (text == NULL) {
+        if (n > 0) {
+            buf[0] = '\0';
         }
-        current = current->next;
+        return 0;
     }
-    printf("]\n");
 
-    pthread_mutex_unlock(&list_mutex); // Unlock after operation
+    if (n > 0) {
+        size_t copied = length < n - 1 ? length : n - 1;
+        memcpy(buf, text, copied);
+        buf[copied] = '\0';
+    }
+    free(text);
+    return length;
 }
 
-void list_insert_before(Node** head, Node* next_node, uint16_t data) {
-    pthread_mutex_lock(&list_mutex);
+size_t list_length(List* list) {
+    return __atomic_load_n(&list->count, __ATOMIC_RELAXED);
+}
 
-    if (*head == NULL || next_node == NULL) {
-        printf("Cannot insert before a NULL node\n");
-        pthread_mutex_unlock(&list_mutex);
-        return;
+size_t list_count_value(List* list, uint16_t data) {
+    epoch_enter();
+    size_t count = 0;
+    for (Node* current = load_link(&list->head); current != NULL; current = load_link(&current->next)) {
+        count += current->data == data;
+    }
+    epoch_exit();
+    return count;
+}
+
+void list_destroy(List* list) {
+    pthread_mutex_lock(&list->lock);
+    clear_locked(list);
+    if (list->index) {
+        mem_free(list->index);
+        list->index = NULL;
+    }
+    if (list->owns_pool) {
+        mem_deinit();
+    }
+    pthread_mutex_unlock(&list->lock);
+    pthread_mutex_destroy(&list->lock);
+}
+
+int list_index_enable(List* list) {
+    pthread_mutex_lock(&list->lock);
+    if (list->index == NULL) {
+        struct ListIndex* index = (struct ListIndex*)mem_alloc(sizeof(struct ListIndex));
+        if (index == NULL) {
+            pthread_mutex_unlock(&list->lock);
+            printf("Memory allocation failed\n");
+            return -1;
+        }
+        index_rebuild(list, index);
+        __atomic_store_n(&list->index, index, __ATOMIC_RELEASE);
+    }
+    pthread_mutex_unlock(&list->lock);
+    return 0;
+}
+
+void list_index_disable(List* list) {
+    pthread_mutex_lock(&list->lock);
+    struct ListIndex* index = list->index;
+    __atomic_store_n(&list->index, NULL, __ATOMIC_RELEASE);
+    epoch_synchronize(); // Readers may still be looking values up in it
+    mem_free(index);
+    pthread_mutex_unlock(&list->lock);
+}
+
+int list_sorted_enable(List* list) {
+    pthread_mutex_lock(&list->lock);
+    if (list->skip != NULL) {
+        pthread_mutex_unlock(&list->lock);
+        return 0;
+    }
+
+    for (Node* current = list->head; current != NULL && current->next != NULL; current = current->next) {
+        if (current->data > current->next->data) {
+            pthread_mutex_unlock(&list->lock);
+            printf("List is not sorted\n");
+            return -1;
+        }
     }
 
-    Node* new_node = (Node*)mem_alloc(sizeof(Node));
-    if (!new_node) {
+    struct SkipList* skip = (struct SkipList*)mem_alloc(sizeof(struct SkipList));
+    if (skip == NULL) {
+        pthread_mutex_unlock(&list->lock);
         printf("Memory allocation failed\n");
-        pthread_mutex_unlock(&list_mutex);
-        return;
+        return -1;
     }
+    memset(skip, 0, sizeof(*skip));
+    skip->rng = 0x9E3779B9u;
+    skip_build(list, skip);
+    __atomic_store_n(&list->skip, skip, __ATOMIC_RELEASE);
 
-    new_node->data = data;
+    pthread_mutex_unlock(&list->lock);
+    return 0;
+}
 
-    if (*head == next_node) {
-        new_node->next = *head;
-        *head = new_node;
+void list_sorted_disable(List* list) {
+    pthread_mutex_lock(&list->lock);
+    struct SkipList* skip = list->skip;
+    if (skip != NULL) {
+        __atomic_store_n(&list->skip, NULL, __ATOMIC_RELEASE);
+        epoch_synchronize(); // Readers may still be descending the towers
+
+        TowerArena* arena = skip->arenas;
+        while (arena != NULL) {
+            TowerArena* next = arena->next;
+            mem_free(arena->memory);
+            free(arena);
+            arena = next;
+        }
+        mem_free(skip);
+    }
+    pthread_mutex_unlock(&list->lock);
+}
+
+Node* list_seek(List* list, uint16_t data) {
+    epoch_enter();
+    struct SkipList* skip = __atomic_load_n(&list->skip, __ATOMIC_ACQUIRE);
+    Node* node;
+    if (skip) {
+        node = skip_seek(list, skip, data);
     } else {
-        Node* current = *head;
-        while (current->next != next_node && current->next != NULL) {
-            current = current->next;
+        node = load_link(&list->head);
+        while (node != NULL && node->data < data) {
+            node = load_link(&node->next);
+        }
+    }
+    epoch_exit();
+    return node;
+}
+
+static inline void iter_push(ListIter* iter, Node* node) {
+    __builtin_prefetch(node);
+    iter->window[(iter->first + iter->count++) % LIST_ITER_WINDOW] = node;
+}
+
+void list_iter_begin(List* list, ListIter* iter) {
+    epoch_enter();
+    iter->first = 0;
+    iter->count = 0;
+    Node* head = load_link(&list->head);
+    if (head != NULL) {
+        iter_push(iter, head);
+    }
+}
+
+Node* list_iter_next(ListIter* iter) {
+    if (iter->count == 0) {
+        return NULL;
+    }
+
+    // Top the window up from its newest node, which was prefetched several calls
+    // ago, so in the steady state each call follows one link that is already cached
+    while (iter->count < LIST_ITER_WINDOW) {
+        Node* newest = iter->window[(iter->first + iter->count - 1) % LIST_ITER_WINDOW];
+        Node* next = load_link(&newest->next);
+        if (next == NULL) {
+            break;
         }
-        if (current->next == next_node) {
-            new_node->next = next_node;
-            current->next = new_node;
+        iter_push(iter, next);
+    }
+
+    Node* node = iter->window[iter->first];
+    iter->first = (iter->first + 1) % LIST_ITER_WINDOW;
+    iter->count--;
+    return node;
+}
+
+void list_iter_end(ListIter* iter) {
+    iter->count = 0;
+    epoch_exit();
+}
+
+int list_compact(List* list) {
+    pthread_mutex_lock(&list->lock);
+    int result = compact_locked(list);
+    pthread_mutex_unlock(&list->lock);
+    return result;
+}
+
+double list_locality(List* list) {
+    epoch_enter();
+    size_t links = 0;
+    size_t sequential = 0;
+    Node* current = load_link(&list->head);
+    for (Node* next; current != NULL && (next = load_link(&current->next)) != NULL; current = next) {
+        links++;
+        sequential += next == current + 1;
+    }
+    epoch_exit();
+    return links ? (double)sequential / links : 1.0;
+}
+
+// A list in sorted mode is already sorted
+void list_sort(List* list) {
+    pthread_mutex_lock(&list->lock);
+    if (list->skip == NULL) {
+        finish_sort(list, merge_sort_chain(list->head));
+    }
+    pthread_mutex_unlock(&list->lock);
+}
+
+void list_sort_parallel(List* list, int num_threads) {
+    if (num_threads < 1) {
+        num_threads = 1;
+    }
+    pthread_mutex_lock(&list->lock);
+    if (list->skip == NULL) {
+        size_t segments = list->count / LIST_SORT_MIN_SEGMENT;
+        if (segments > (size_t)num_threads) {
+            segments = num_threads;
+        }
+        if (segments < 2) {
+            finish_sort(list, merge_sort_chain(list->head));
         } else {
-            printf("Next node not found in the list\n");
-            mem_free(new_node);
+            finish_sort(list, parallel_sort_chain(list->head, list->count, (int)segments));
         }
     }
+    pthread_mutex_unlock(&list->lock);
+}
 
-    pthread_mutex_unlock(&list_mutex);
+void list_sort_radix(List* list) {
+    pthread_mutex_lock(&list->lock);
+    if (list->skip == NULL) {
+        finish_sort(list, radix_sort_chain(list->head));
+    }
+    pthread_mutex_unlock(&list->lock);
 }
 
-void list_display_range(Node* head, size_t start, size_t end) {
-    pthread_mutex_lock(&list_mutex);
+// ********* Node ** compatibility wrappers *********
 
-    size_t index = 0;
-    printf("[");
-    while (head != NULL && index <= end) {
-        if (index >= start) {
-            printf("%u", head->data);
-            if (index < end && head->next != NULL) {
-                printf(", ");
-            }
+// Points the default list at the caller's head. If the caller's list is not the one
+// the default list last saw, its tail, count, prev pointers and index are recomputed
+// with one walk and its position checkpoints are dropped. Caller must hold the default list lock.
+static List* bind_default(Node** head) {
+    if (default_list.head != *head) {
+        // The index describes the previous list, so readers scan until it is rebuilt
+        struct ListIndex* index = default_list.index;
+        if (index) {
+            __atomic_store_n(&default_list.index, NULL, __ATOMIC_RELEASE);
+            epoch_synchronize();
+        }
+        publish_link(&default_list.head, *head);
+        default_list.tail = NULL;
+        size_t count = 0;
+        for (Node* current = *head; current != NULL; current = current->next) {
+            current->prev = default_list.tail;
+            default_list.tail = current;
+            count++;
+        }
+        set_count(&default_list, count);
+        default_list.checkpoints_valid = 0;
+        if (index) {
+            index_rebuild(&default_list, index);
+            __atomic_store_n(&default_list.index, index, __ATOMIC_RELEASE);
         }
-        head = head->next;
-        index++;
     }
-    printf("]\n");
+    return &default_list;
+}
 
-    pthread_mutex_unlock(&list_mutex);
+// Initializes the linked list and memory manager
+void list_init(Node** head, size_t size) {
+    *head = NULL;
+    // The default list keeps its statically initialized lock
+    reset_list(&default_list);
+    default_list.owns_pool = 1;
+    mem_init(size);
+}
+
+// Initializes the linked list with a value index, growing the pool to hold it
+void list_init_indexed(Node** head, size_t size) {
+    list_init(head, size + LIST_INDEX_BYTES);
+    list_index_enable(&default_list);
+}
+
+// Inserts a new node at the end of the list
+void list_insert(Node** head, uint16_t data) {
+    pthread_mutex_lock(&default_list.lock);
+    append_locked(bind_default(head), data);
+    publish_link(head, default_list.head);
+    pthread_mutex_unlock(&default_list.lock);
+}
+
+// Deletes the first node with the specified data
+void list_delete(Node** head, uint16_t data) {
+    pthread_mutex_lock(&default_list.lock); // Lock for thread safety
+    remove_locked(bind_default(head), data);
+    publish_link(head, default_list.head);
+    pthread_mutex_unlock(&default_list.lock); // Unlock after operation
+}
+
+// Searches for a node with the specified data without taking the lock
+Node* list_search(Node** head, uint16_t data) {
+    epoch_enter();
+    Node* first = load_link(head);
+    Node* node = first == load_link(&default_list.head) ? find_locked(&default_list, data) : scan_from(first, data);
+    epoch_exit();
+    return node;
+}
+
+// Inserts a new node after a given node. There is no head to bind, so prev_node
+// must be in the list whose head the other wrappers were passed last.
+void list_insert_after(Node* prev_node, uint16_t data) {
+    list_add_after(&default_list, prev_node, data);
 }
-// Counts the total number of nodes in the list
-int list_count_nodes(Node** head) {
-    pthread_mutex_lock(&list_mutex); // Lock for thread safety
 
-    int count = 0;
-    Node* current = *head;
-    while (current != NULL) {
-        count++;
-        current = current->next;
+// Displays all elements in the list
+void list_display(Node** head) {
+    print_range(head, NULL, NULL, list_length(&default_list), "\n");
+}
+
+void list_insert_before(Node** head, Node* next_node, uint16_t data) {
+    if (reject_positional(&default_list)) {
+        return;
     }
 
-    pthread_mutex_unlock(&list_mutex); // Unlock after operation
+    pthread_mutex_lock(&default_list.lock);
+    add_before_locked(bind_default(head), next_node, data);
+    publish_link(head, default_list.head);
+    pthread_mutex_unlock(&default_list.lock);
+}
+
+// Displays the elements from start_node to end_node inclusive; NULL means the
+// first or last node respectively
+void list_display_range(Node** head, Node* start_node, Node* end_node) {
+    print_range(head, start_node, end_node, 0, "");
+}
+
+// Counts the total number of nodes in the list; only a list the default list has
+// not seen yet needs the lock, to be bound
+int list_count_nodes(Node** head) {
+    if (load_link(head) == load_link(&default_list.head)) {
+        return (int)list_length(&default_list);
+    }
+
+    pthread_mutex_lock(&default_list.lock); // Lock for thread safety
+    int count = (int)bind_default(head)->count;
+    pthread_mutex_unlock(&default_list.lock); // Unlock after operation
     return count;
 }
 
 // Frees all nodes in the list and deallocates the memory manager
 void list_cleanup(Node** head) {
-    pthread_mutex_lock(&list_mutex); // Lock for thread safety
-
-    Node* current = *head;
-    while (current != NULL) {
-        Node* next_node = current->next;
-        mem_free(current);
-        current = next_node;
-    }
+    pthread_mutex_lock(&default_list.lock); // Lock for thread safety
+    clear_locked(bind_default(head));
     *head = NULL;
-
+    default_list.index = NULL; // Released with the pool
     mem_deinit();
-
-    pthread_mutex_unlock(&list_mutex); // Unlock after operation
-}
\ No newline at end of file
+    pthread_mutex_unlock(&default_list.lock); // Unlock after operation
+}
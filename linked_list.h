@@ -6,12 +6,27 @@
 #include <stdint.h>
 #include <pthread.h>
 
+// The lock-free and lock coupling builds only provide the Node ** interface below
+#if !defined(LIST_LOCK_FREE) && !defined(LIST_LOCK_COUPLING)
+#define LIST_HANDLE_API
+#endif
+
 typedef struct Node
 {
     uint16_t data;     // Stores the data as an unsigned 16-bit integer
+#ifdef LIST_HANDLE_API
+    uint32_t checkpoint; // Slot of this node in its list's checkpoints, offset by checkpoint_base; may be stale
+#endif
     struct Node *next; // Pointer to the next node in the list
-    pthread_mutex_t lock;
-
+#ifdef LIST_HANDLE_API
+    struct Node *prev; // Pointer to the previous node, NULL for the first node
+#endif
+#ifdef LIST_LOCK_COUPLING
+    pthread_mutex_t lock; // Per-node lock, only used by the lock coupling implementation
+#endif
+#ifdef LIST_LOCK_FREE
+    struct Node *retired; // Next node in the same retired batch, only used by the lock-free implementation
+#endif
 } Node;
 
 // Function declarations
@@ -28,4 +43,158 @@ void list_display_range(Node **head, Node *start_node, Node *end_node);
 int list_count_nodes(Node **head);
 void list_cleanup(Node **head);
 
+#ifdef LIST_HANDLE_API
+// Optional value index: one entry per possible uint16_t value
+#define LIST_INDEX_KEYS 65536
+// Pool bytes taken by the value index, to be added to the size passed at init
+#define LIST_INDEX_BYTES (LIST_INDEX_KEYS * (sizeof(Node **) + sizeof(uint32_t)))
+
+struct ListIndex;
+struct NodeChunk;
+struct SkipList;
+
+// Doubly-linked list handle that tracks the tail and the node count, so appending,
+// counting, inserting before a node and removing a given node are O(1). The Node **
+// functions above are wrappers around an internal List that switches to each head
+// passed to them. list_insert_after takes no head and inserts into the list whose
+// head was passed last, so prev_node must belong to that list.
+// Finding, printing, counting and exporting never lock; they may run concurrently
+// with writers. Writers to the same list are serialized by its lock; separate lists
+// share no lock.
+typedef struct List
+{
+    pthread_mutex_t lock;     // Serializes writers to this list
+    int owns_pool;            // Whether list_destroy also deinitializes the pool
+    Node *head;               // First node, NULL when the list is empty
+    Node *tail;               // Last node, NULL when the list is empty
+    size_t count;             // Number of nodes in the list
+    struct ListIndex *index;  // Value index, NULL unless enabled
+    Node *free_nodes;         // Recycled nodes, linked through next
+    struct NodeChunk *chunks; // Node chunks reserved from the pool
+    Node *retired;            // Unlinked nodes readers may still be on, linked through prev
+    Node *sealed;             // Older retired nodes waiting for their grace period
+    uint64_t retired_stamp;   // Epoch stamp of the newest node in retired
+    uint64_t sealed_stamp;    // Epoch stamp of the newest node in sealed
+    size_t retired_count;     // Number of nodes in retired
+    struct SkipList *skip;    // Skip list over the nodes in sorted mode, NULL otherwise
+    Node **checkpoints;         // The head, then about every 64th node by position, for positional seeks
+    size_t checkpoint_capacity; // Slots allocated in checkpoints
+    size_t checkpoints_valid;   // Leading checkpoints that are up to date
+    long checkpoint_offset;     // Shift of checkpoints after the head from multiples of 64
+    uint32_t checkpoint_base;   // Added to a slot number to get the Node checkpoint field
+} List;
+
+// list_create initializes the memory pool with the given size for the list;
+// list_create_shared allocates from a pool the caller already initialized with
+// mem_init, so any number of lists can share it.
+void list_create(List *list, size_t size);
+void list_create_shared(List *list);
+void list_append(List *list, uint16_t data);
+void list_add_after(List *list, Node *prev_node, uint16_t data);
+void list_add_before(List *list, Node *next_node, uint16_t data);
+void list_remove(List *list, uint16_t data);
+void list_remove_node(List *list, Node *node);
+Node *list_find(List *list, uint16_t data);
+
+void list_print(List *list);
+void list_print_range(List *list, Node *start_node, Node *end_node);
+// Writes the list as "[a, b, c]" into buf, truncated to n - 1 characters and
+// NUL-terminated. Returns the length of the full text, like snprintf.
+size_t list_format(List *list, char *buf, size_t n);
+// Positional access: list_at returns the node at a 0-based position (NULL past the
+// end) and list_print_slice prints positions start to end inclusive. Seeking uses
+// a checkpoint every 64 positions, so it does not walk from the head.
+Node *list_at(List *list, size_t index);
+void list_print_slice(List *list, size_t start, size_t end);
+
+size_t list_length(List *list);
+// Counts the nodes holding data
+size_t list_count_value(List *list, uint16_t data);
+void list_destroy(List *list);
+
+// Bulk operations: append a whole array under one lock with one batched allocation,
+// create a list from an array, and copy up to max values out in list order.
+// The first two return the number of values appended.
+size_t list_insert_many(List *list, const uint16_t *values, size_t count);
+size_t list_from_array(List *list, size_t size, const uint16_t *values, size_t count);
+size_t list_to_array(List *list, uint16_t *out, size_t max);
+
+// Snapshots: list_save writes the values to a flat file, replaced atomically and
+// synced to disk before it returns, and list_load appends the values of a snapshot
+// to a list with one bulk insert straight from the mapped file. A ListView maps a
+// snapshot read-only and exposes its values as an array without building a list.
+// All return 0, or -1 if the file cannot be written or read or is not a snapshot.
+typedef struct ListView
+{
+    const uint16_t *values; // Values in list order, inside the mapping
+    size_t count;
+    void *map;              // The whole mapped file
+    size_t map_size;
+} ListView;
+
+int list_save(List *list, const char *path);
+int list_load(List *list, const char *path);
+int list_view_open(ListView *view, const char *path);
+void list_view_close(ListView *view);
+
+// Value index: makes finding and removing by value O(1) for values stored once.
+// The index takes LIST_INDEX_BYTES from the pool; returns 0, or -1 if that fails.
+int list_index_enable(List *list);
+void list_index_disable(List *list);
+void list_init_indexed(Node **head, size_t size);
+
+// Sorted mode: a skip list, allocated from the pool, is layered over the nodes.
+// Appends (list_append, list_insert_many, list_insert) insert in value order in
+// O(log n), finding by value is O(log n) and positional inserts are rejected.
+// Enabling fails with -1 if the list is not sorted or the pool is full.
+int list_sorted_enable(List *list);
+void list_sorted_disable(List *list);
+// Returns the first node whose value is not below data, for starting range walks
+Node *list_seek(List *list, uint16_t data);
+
+// Cursor over a List that prefetches the next LIST_ITER_WINDOW nodes to hide the
+// latency of following links. From list_iter_begin to list_iter_end the thread is
+// in an epoch read section: returned nodes stay valid even if other threads remove
+// them, and changes made meanwhile may or may not be seen. While iterating, the thread
+// may call the read functions that do not lock (list_find, list_seek, list_length,
+// list_count_value, list_to_array, list_print, list_print_range, list_format and
+// list_locality). It must not call list_at or list_print_slice, which take the list
+// lock that writers hold while waiting for read sections to end, and must not modify
+// any list until list_iter_end.
+#define LIST_ITER_WINDOW 8
+
+typedef struct ListIter
+{
+    Node *window[LIST_ITER_WINDOW]; // Upcoming nodes, oldest first from slot first
+    unsigned first;                 // Slot of the node list_iter_next returns next
+    unsigned count;                 // Nodes in the window
+} ListIter;
+
+void list_iter_begin(List *list, ListIter *iter);
+// Returns the next node, or NULL past the last one
+Node *list_iter_next(ListIter *iter);
+void list_iter_end(ListIter *iter);
+
+// Compaction: list_compact copies the nodes in list order into contiguous chunks and
+// releases the old ones once no reader is on them, so traversals read memory
+// sequentially. Node pointers obtained before the call no longer belong to the list
+// afterwards. Needs room in the pool for a second copy of the nodes; returns 0, or
+// -1 if there is none. list_locality returns the fraction of links that point to the
+// next node in memory, 1.0 right after compaction, as a cue for when to compact.
+int list_compact(List *list);
+double list_locality(List *list);
+
+// Sorting: stable, in place, relinking the nodes without allocating. list_sort is a
+// merge sort, list_sort_parallel merge sorts segments on up to num_threads threads
+// and merges them (fewer than one thread counts as one), list_sort_radix is a
+// two-pass radix sort in O(n). The readers, which do not lock, are not consistent
+// with a sort: while the nodes are relinked, list_find, list_to_array and iterators
+// may skip nodes or return some twice, and list_find may miss a value that is
+// present while the value index is rebuilt. Take the list lock around reads that
+// must not overlap a sort.
+void list_sort(List *list);
+void list_sort_parallel(List *list, int num_threads);
+void list_sort_radix(List *list);
+#endif
+
 #endif // LINKED_LIST_H
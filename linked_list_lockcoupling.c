@@ -0,0 +1,259 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "linked_list.h"
+
+// Fine-grained implementation of the linked_list.h API using hand-over-hand
+// (lock coupling) locking with the per-node lock declared in Node. A traversal
+// always holds the lock of the node it stands on and takes the next node's lock
+// before releasing it, so threads working on different parts of the list run in
+// parallel. head_lock plays the role of the predecessor lock for *head.
+// list_insert_after and list_display_range lock the node they are given directly,
+// so that node must not be deleted concurrently.
+// Build with -DLIST_LOCK_COUPLING so Node contains its lock.
+
+#ifndef LIST_LOCK_COUPLING
+#error "linked_list_lockcoupling.c must be compiled with -DLIST_LOCK_COUPLING"
+#endif
+
+static pthread_mutex_t head_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static Node* new_node(uint16_t data) {
+    Node* node = (Node*)mem_alloc(sizeof(Node));
+    if (!node) {
+        printf("Memory allocation failed\n");
+        return NULL;
+    }
+    node->data = data;
+    node->next = NULL;
+    pthread_mutex_init(&node->lock, NULL);
+    return node;
+}
+
+static void free_node(Node* node) {
+    pthread_mutex_destroy(&node->lock);
+    mem_free(node);
+}
+
+// Locks the first node and releases head_lock. Returns NULL, with head_lock
+// released, if the list is empty. Caller must hold head_lock.
+static Node* lock_first(Node** head) {
+    Node* current = *head;
+    if (current) {
+        pthread_mutex_lock(&current->lock);
+    }
+    pthread_mutex_unlock(&head_lock);
+    return current;
+}
+
+// Moves the traversal one node forward: locks current->next, then releases current.
+static Node* lock_next(Node* current) {
+    Node* next = current->next;
+    if (next) {
+        pthread_mutex_lock(&next->lock);
+    }
+    pthread_mutex_unlock(&current->lock);
+    return next;
+}
+
+// Initializes the linked list and memory manager
+void list_init(Node** head, size_t size) {
+    *head = NULL;
+    mem_init(size);
+}
+
+// Inserts a new node at the end of the list
+void list_insert(Node** head, uint16_t data) {
+    Node* node = new_node(data);
+    if (!node) {
+        return;
+    }
+
+    pthread_mutex_lock(&head_lock);
+    if (*head == NULL) {
+        *head = node;
+        pthread_mutex_unlock(&head_lock);
+        return;
+    }
+
+    Node* current = lock_first(head);
+    while (current->next != NULL) {
+        current = lock_next(current);
+    }
+    current->next = node;
+    pthread_mutex_unlock(&current->lock);
+}
+
+// Inserts a new node after a given node
+void list_insert_after(Node* prev_node, uint16_t data) {
+    if (!prev_node) {
+        printf("Previous node cannot be NULL\n");
+        return;
+    }
+
+    Node* node = new_node(data);
+    if (!node) {
+        return;
+    }
+
+    pthread_mutex_lock(&prev_node->lock);
+    node->next = prev_node->next;
+    prev_node->next = node;
+    pthread_mutex_unlock(&prev_node->lock);
+}
+
+// Inserts a new node before a given node
+void list_insert_before(Node** head, Node* next_node, uint16_t data) {
+    if (next_node == NULL) {
+        printf("Cannot insert before a NULL node\n");
+        return;
+    }
+
+    Node* node = new_node(data);
+    if (!node) {
+        return;
+    }
+    node->next = next_node;
+
+    pthread_mutex_lock(&head_lock);
+    if (*head == next_node) {
+        *head = node;
+        pthread_mutex_unlock(&head_lock);
+        return;
+    }
+
+    Node* current = lock_first(head);
+    while (current != NULL && current->next != next_node) {
+        current = lock_next(current);
+    }
+
+    if (current == NULL) {
+        printf("Next node not found in the list\n");
+        free_node(node);
+        return;
+    }
+    current->next = node;
+    pthread_mutex_unlock(&current->lock);
+}
+
+// Deletes the first node with the specified data
+void list_delete(Node** head, uint16_t data) {
+    pthread_mutex_lock(&head_lock);
+
+    Node* current = *head;
+    if (current == NULL) {
+        printf("List is empty\n");
+        pthread_mutex_unlock(&head_lock);
+        return;
+    }
+
+    pthread_mutex_lock(&current->lock);
+    if (current->data == data) {
+        *head = current->next;
+        pthread_mutex_unlock(&current->lock);
+        pthread_mutex_unlock(&head_lock);
+        free_node(current);
+        return;
+    }
+    pthread_mutex_unlock(&head_lock);
+
+    // Hold both the predecessor and the candidate so the unlink cannot race
+    Node* previous = current;
+    current = previous->next;
+    while (current != NULL) {
+        pthread_mutex_lock(&current->lock);
+        if (current->data == data) {
+            previous->next = current->next;
+            pthread_mutex_unlock(&current->lock);
+            pthread_mutex_unlock(&previous->lock);
+            free_node(current);
+            return;
+        }
+        pthread_mutex_unlock(&previous->lock);
+        previous = current;
+        current = current->next;
+    }
+
+    pthread_mutex_unlock(&previous->lock);
+    printf("Data not found in the list\n");
+}
+
+// Searches for a node with the specified data
+Node* list_search(Node** head, uint16_t data) {
+    pthread_mutex_lock(&head_lock);
+
+    Node* current = lock_first(head);
+    while (current != NULL && current->data != data) {
+        current = lock_next(current);
+    }
+
+    if (current) {
+        pthread_mutex_unlock(&current->lock);
+    }
+    return current;
+}
+
+// Displays all elements in the list
+void list_display(Node** head) {
+    list_display_range(head, NULL, NULL);
+    printf("\n");
+}
+
+// Displays the elements from start_node to end_node inclusive; NULL means the
+// first or last node respectively
+void list_display_range(Node** head, Node* start_node, Node* end_node) {
+    Node* current;
+    if (start_node) {
+        pthread_mutex_lock(&start_node->lock);
+        current = start_node;
+    } else {
+        pthread_mutex_lock(&head_lock);
+        current = lock_first(head);
+    }
+
+    printf("[");
+    while (current != NULL) {
+        printf("%u", current->data);
+        if (current == end_node) {
+            pthread_mutex_unlock(&current->lock);
+            break;
+        }
+        if (current->next != NULL) {
+            printf(", ");
+        }
+        current = lock_next(current);
+    }
+    printf("]");
+}
+
+// Counts the total number of nodes in the list
+int list_count_nodes(Node** head) {
+    pthread_mutex_lock(&head_lock);
+
+    int count = 0;
+    Node* current = lock_first(head);
+    while (current != NULL) {
+        count++;
+        current = lock_next(current);
+    }
+
+    return count;
+}
+
+// Frees all nodes in the list and deallocates the memory manager.
+// Must not run concurrently with other operations on the list.
+void list_cleanup(Node** head) {
+    pthread_mutex_lock(&head_lock);
+
+    Node* current = *head;
+    while (current != NULL) {
+        Node* next_node = current->next;
+        free_node(current);
+        current = next_node;
+    }
+    *head = NULL;
+
+    mem_deinit();
+
+    pthread_mutex_unlock(&head_lock);
+}
@@ -0,0 +1,362 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include "linked_list.h"
+#include "epoch.h"
+
+// Lock-free implementation of the linked_list.h API (Harris/Michael style).
+// A node is deleted in two steps: the low bit of its next pointer is set to mark
+// it as logically deleted, then it is unlinked with a CAS on its predecessor's
+// next pointer (or on *head). Traversals unlink any marked node they meet.
+
+#define MARK_BIT ((uintptr_t)1)
+
+static inline int is_marked(Node* ptr) {
+    return ((uintptr_t)ptr & MARK_BIT) != 0;
+}
+
+static inline Node* with_mark(Node* ptr) {
+    return (Node*)((uintptr_t)ptr | MARK_BIT);
+}
+
+static inline Node* without_mark(Node* ptr) {
+    return (Node*)((uintptr_t)ptr & ~MARK_BIT);
+}
+
+static inline Node* load_link(Node** link) {
+    return __atomic_load_n(link, __ATOMIC_ACQUIRE);
+}
+
+static inline int cas_link(Node** link, Node* expected, Node* desired) {
+    return __atomic_compare_exchange_n(link, &expected, desired, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+// Deferred reclamation through epoch.c: every operation is a read section, and
+// unlinked nodes are retired into a shared batch, chained through their retired
+// field. Every LF_RECLAIM_INTERVAL retirements a thread seals the open batch with
+// the current epoch stamp and frees the previously sealed batch once no read
+// section that could still reach it is running. Operations only touch their own
+// epoch record, so readers on different cores do not share a cache line.
+#define LF_RECLAIM_INTERVAL 64
+
+static Node* retired = NULL;        // Open batch, pushed to without a lock
+static Node* sealed = NULL;         // Batch waiting for its stamp to fall below the reclaim bound
+static uint64_t sealed_stamp = 0;
+static pthread_mutex_t reclaim_lock = PTHREAD_MUTEX_INITIALIZER; // Guards sealed and sealed_stamp
+static __thread unsigned retires_since_reclaim = 0;
+
+static size_t free_retired(Node* node) {
+    size_t count = 0;
+    while (node != NULL) {
+        Node* next = node->retired;
+        mem_free(node);
+        node = next;
+        count++;
+    }
+    return count;
+}
+
+// Frees the sealed batch if no reader can reach it any more and seals the open batch
+// in its place. Threads that find another one reclaiming simply move on.
+static void try_reclaim(void) {
+    if (pthread_mutex_trylock(&reclaim_lock) != 0) {
+        return;
+    }
+
+    if (sealed != NULL && sealed_stamp < epoch_reclaim_bound()) {
+        free_retired(sealed);
+        sealed = NULL;
+    }
+    if (sealed == NULL) {
+        // Every node in the batch was unlinked before the exchange, so the stamp covers them all
+        sealed = __atomic_exchange_n(&retired, NULL, __ATOMIC_ACQ_REL);
+        sealed_stamp = epoch_stamp();
+    }
+
+    pthread_mutex_unlock(&reclaim_lock);
+}
+
+// Waits for every running operation to finish and frees all retired nodes. Used when
+// the pool runs dry, so must not be called from inside an operation. Returns the
+// number of nodes freed.
+static size_t reclaim_all(void) {
+    pthread_mutex_lock(&reclaim_lock);
+    Node* batch = __atomic_exchange_n(&retired, NULL, __ATOMIC_ACQ_REL);
+    epoch_synchronize();
+    size_t count = free_retired(sealed) + free_retired(batch);
+    sealed = NULL;
+    pthread_mutex_unlock(&reclaim_lock);
+    return count;
+}
+
+static void retire(Node* node) {
+    node->retired = __atomic_load_n(&retired, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&retired, &node->retired, node, 1, __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+    }
+    if (++retires_since_reclaim >= LF_RECLAIM_INTERVAL) {
+        retires_since_reclaim = 0;
+        try_reclaim();
+    }
+}
+
+static inline void op_enter(void) {
+    epoch_enter();
+}
+
+static inline void op_exit(void) {
+    epoch_exit();
+}
+
+typedef int (*match_fn)(const Node* node, const void* arg);
+
+static int match_data(const Node* node, const void* arg) {
+    return node->data == *(const uint16_t*)arg;
+}
+
+static int match_node(const Node* node, const void* arg) {
+    return node == (const Node*)arg;
+}
+
+// Walks the list, unlinking marked nodes on the way, and returns the first live node
+// accepted by match (or NULL at the end of the list, when match is NULL or nothing
+// matched). *link_out receives the link that points to the returned node.
+static Node* find(Node** head, match_fn match, const void* arg, Node*** link_out) {
+retry:;
+    Node** link = head;
+    Node* current = load_link(link);
+
+    while (current != NULL) {
+        Node* next = load_link(&current->next);
+        if (is_marked(next)) {
+            if (!cas_link(link, current, without_mark(next))) {
+                goto retry;
+            }
+            retire(current);
+            current = without_mark(next);
+            continue;
+        }
+        if (match && match(current, arg)) {
+            break;
+        }
+        link = &current->next;
+        current = next;
+    }
+
+    *link_out = link;
+    return current;
+}
+
+static Node* new_node(uint16_t data) {
+    Node* node = (Node*)mem_alloc(sizeof(Node));
+    // The pool may only be full of retired nodes. Other threads can take the freed
+    // ones first, so retry as long as reclaiming makes progress.
+    while (!node) {
+        size_t freed = reclaim_all();
+        node = (Node*)mem_alloc(sizeof(Node));
+        if (freed == 0) {
+            break;
+        }
+    }
+    if (!node) {
+        printf("Memory allocation failed\n");
+        return NULL;
+    }
+    node->data = data;
+    node->next = NULL;
+    return node;
+}
+
+// Initializes the linked list and memory manager
+void list_init(Node** head, size_t size) {
+    *head = NULL;
+    mem_init(size);
+}
+
+// Inserts a new node at the end of the list
+void list_insert(Node** head, uint16_t data) {
+    Node* node = new_node(data);
+    if (!node) {
+        return;
+    }
+
+    op_enter();
+    Node** link;
+    do {
+        find(head, NULL, NULL, &link);
+    } while (!cas_link(link, NULL, node));
+    op_exit();
+}
+
+// Inserts a new node after a given node
+void list_insert_after(Node* prev_node, uint16_t data) {
+    if (!prev_node) {
+        printf("Previous node cannot be NULL\n");
+        return;
+    }
+
+    Node* node = new_node(data);
+    if (!node) {
+        return;
+    }
+
+    op_enter();
+    for (;;) {
+        Node* next = load_link(&prev_node->next);
+        if (is_marked(next)) {
+            printf("Previous node has been deleted\n");
+            mem_free(node);
+            break;
+        }
+        node->next = next;
+        if (cas_link(&prev_node->next, next, node)) {
+            break;
+        }
+    }
+    op_exit();
+}
+
+// Inserts a new node before a given node
+void list_insert_before(Node** head, Node* next_node, uint16_t data) {
+    if (next_node == NULL) {
+        printf("Cannot insert before a NULL node\n");
+        return;
+    }
+
+    Node* node = new_node(data);
+    if (!node) {
+        return;
+    }
+    node->next = next_node;
+
+    op_enter();
+    for (;;) {
+        Node** link;
+        if (find(head, match_node, next_node, &link) == NULL) {
+            printf("Next node not found in the list\n");
+            mem_free(node);
+            break;
+        }
+        if (cas_link(link, next_node, node)) {
+            break;
+        }
+    }
+    op_exit();
+}
+
+// Deletes the first node with the specified data
+void list_delete(Node** head, uint16_t data) {
+    op_enter();
+
+    if (load_link(head) == NULL) {
+        printf("List is empty\n");
+        op_exit();
+        return;
+    }
+
+    for (;;) {
+        Node** link;
+        Node* current = find(head, match_data, &data, &link);
+        if (current == NULL) {
+            printf("Data not found in the list\n");
+            break;
+        }
+
+        // Logical deletion: whoever sets the mark owns the delete
+        Node* next = load_link(&current->next);
+        if (is_marked(next) || !cas_link(&current->next, next, with_mark(next))) {
+            continue;
+        }
+
+        // Physical deletion; if it fails a later traversal unlinks the node
+        if (cas_link(link, current, next)) {
+            retire(current);
+        }
+        break;
+    }
+
+    op_exit();
+}
+
+// Searches for a node with the specified data
+Node* list_search(Node** head, uint16_t data) {
+    op_enter();
+
+    Node* current = load_link(head);
+    while (current != NULL) {
+        Node* next = load_link(&current->next);
+        if (!is_marked(next) && current->data == data) {
+            break;
+        }
+        current = without_mark(next);
+    }
+
+    op_exit();
+    return current;
+}
+
+// Displays all elements in the list
+void list_display(Node** head) {
+    list_display_range(head, NULL, NULL);
+    printf("\n");
+}
+
+// Displays the elements from start_node to end_node inclusive; NULL means the
+// first or last node respectively
+void list_display_range(Node** head, Node* start_node, Node* end_node) {
+    op_enter();
+
+    Node* current = start_node ? start_node : load_link(head);
+    int first = 1;
+    printf("[");
+    while (current != NULL) {
+        Node* next = load_link(&current->next);
+        if (!is_marked(next)) {
+            printf(first ? "%u" : ", %u", current->data);
+            first = 0;
+        }
+        if (current == end_node) {
+            break;
+        }
+        current = without_mark(next);
+    }
+    printf("]");
+
+    op_exit();
+}
+
+// Counts the total number of nodes in the list
+int list_count_nodes(Node** head) {
+    op_enter();
+
+    int count = 0;
+    Node* current = load_link(head);
+    while (current != NULL) {
+        Node* next = load_link(&current->next);
+        if (!is_marked(next)) {
+            count++;
+        }
+        current = without_mark(next);
+    }
+
+    op_exit();
+    return count;
+}
+
+// Frees all nodes in the list and deallocates the memory manager.
+// Must not run concurrently with other operations on the list.
+void list_cleanup(Node** head) {
+    free_retired(__atomic_exchange_n(&retired, NULL, __ATOMIC_ACQUIRE));
+    free_retired(sealed);
+    sealed = NULL;
+
+    Node* current = *head;
+    while (current != NULL) {
+        Node* next = without_mark(current->next);
+        mem_free(current);
+        current = next;
+    }
+    *head = NULL;
+
+    mem_deinit();
+}
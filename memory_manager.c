@@ -4,23 +4,203 @@
 #include <string.h>
 #include <errno.h>
 #include <pthread.h>
+#include <math.h>
+#include <execinfo.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "memory_manager.h"
+
+#define QUARANTINE_POISON 0xFD // Byte pattern written over quarantined blocks
+#define PROFILE_MAX_DEPTH 32   // Deepest call stack recorded for a sampled allocation
+#define EVENT_BATCH 16         // Events collected under memory_lock before being dispatched
+#define LOG_RATE_LIMIT 10      // Messages per second written by the default error callback
+
+#define POOL_FILE_MAGIC "MEMPOOL"
+#define POOL_FILE_VERSION 1
+#define POOL_FILE_HEADER 4096   // Bytes reserved for the header, so the pool starts page aligned
+#define POOL_TAG_FREE 0x65657266 // Tag states, chosen so that a stray word is not read as a tag
+#define POOL_TAG_USED 0x64657375
+#define SHARED_ATTACH_WAIT_MS 5000 // How long attaching waits for the creator to format a shared pool
+
+// Call stack and estimated weight of one sampled allocation
+typedef struct ProfileSample {
+    void* stack[PROFILE_MAX_DEPTH];
+    int depth;
+    size_t size;   // Requested size of the sampled allocation
+    double weight; // Bytes this sample stands for, corrected for the sampling probability
+} ProfileSample;
 
 typedef struct MemBlock {
     size_t block_size;           
     int is_available;            
     struct MemBlock* next_block; 
     void* data_ptr;              
+    int in_quarantine;                 // Freed, poisoned and waiting in the quarantine FIFO
+    struct MemBlock* next_quarantined; // Next (younger) block in the quarantine FIFO
+    void* alloc_site;                  // Return address of the mem_alloc caller
+    void* free_site;                   // Return address of the mem_free caller
+    ProfileSample* sample;             // Heap profiler record while the block is live and sampled
 } MemBlock;
 
+// Header at the start of a pool file. Offsets are relative to the start of the pool.
+typedef struct PoolFileHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t tag_size;
+    uint64_t pool_size; // Bytes after the header, tags included
+    uint64_t base;      // Address the pool was mapped at; pointers stored in the pool assume it
+    uint64_t root;      // Offset of the root block, or 0 if none was set
+    uint64_t generation; // Shared pools: bumped on every change, telling other processes to reload the tags
+    pthread_mutex_t lock; // Shared pools: process-shared robust mutex guarding the tags
+} PoolFileHeader;
+
+// Every block of a file-backed pool is preceded by a tag, so the block list can be
+// rebuilt from the file alone. The tag of the next block follows the data.
+typedef struct PoolTag {
+    uint64_t size;  // Data bytes after the tag
+    uint64_t state; // POOL_TAG_FREE or POOL_TAG_USED
+} PoolTag;
+
+// Events raised while memory_lock is held, dispatched once it has been released
+typedef struct MemEvents {
+    MemEvent events[EVENT_BATCH];
+    int count;
+    MemErrorCallback callback; // Registration current when the first event was raised
+    void* user_data;
+} MemEvents;
+
 void* pool_start = NULL;       
 MemBlock* pool_head = NULL;    
 size_t total_pool_size = 0;    
 
+// File-backed pool, NULL while the pool lives on the heap
+PoolFileHeader* pool_file = NULL;
+size_t tag_bytes = 0; // Bytes in front of every block: sizeof(PoolTag) for a file pool, 0 otherwise
+int pool_shared = 0;  // The file pool is shared with other processes
+uint64_t shared_generation = 0; // Generation of the shared pool the block list was loaded at
+
+// Use-after-free quarantine, disabled while quarantine_limit is 0
+MemBlock* quarantine_head = NULL; // Oldest quarantined block, evicted first
+MemBlock* quarantine_tail = NULL;
+size_t quarantine_bytes = 0;
+size_t quarantine_limit = 0;
+
+// Sampling heap profiler, disabled while profile_interval is 0. The interval is
+// written under memory_lock but read without it, so it is accessed atomically.
+size_t profile_interval = 0;
+static __thread double bytes_until_sample = 0; // Per-thread countdown to the next sample
+static __thread size_t sample_interval_seen = 0; // Interval the countdown was drawn for
+static __thread uint64_t sample_rng = 0;
+
+static void default_error_callback(const MemEvent* event, void* user_data);
+static void profile_clear(void);
+static void close_pool(void);
+
+MemErrorCallback error_callback = default_error_callback;
+void* error_user_data = NULL;
+
+// Rate limiting state of the default error callback
+static time_t log_window = 0;
+static unsigned log_count = 0;
+static unsigned log_suppressed = 0;
+
 pthread_mutex_t memory_lock = PTHREAD_MUTEX_INITIALIZER; // Global mutex for thread safety
 
+const char* mem_error_string(MemErrorCode code) {
+    switch (code) {
+    case MEM_ERR_INVALID_FREE:    return "pointer was not allocated from this pool";
+    case MEM_ERR_DOUBLE_FREE:     return "block is already free";
+    case MEM_ERR_INVALID_RESIZE:  return "resize of a pointer that is not allocated";
+    case MEM_ERR_USE_AFTER_FREE:  return "use-after-free write";
+    case MEM_ERR_METADATA:        return "failed to allocate block metadata";
+    default:                      return "unknown error";
+    }
+}
+
+void mem_error_callback_noop(const MemEvent* event, void* user_data) {
+    (void)event;
+    (void)user_data;
+}
+
+// Logs to stderr, at most LOG_RATE_LIMIT messages per second
+static void default_error_callback(const MemEvent* event, void* user_data) {
+    (void)user_data;
+
+    time_t now = time(NULL);
+    time_t window = __atomic_load_n(&log_window, __ATOMIC_RELAXED);
+    if (now != window && __atomic_compare_exchange_n(&log_window, &window, now, 0, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+        __atomic_store_n(&log_count, 0, __ATOMIC_RELAXED);
+        unsigned suppressed = __atomic_exchange_n(&log_suppressed, 0, __ATOMIC_RELAXED);
+        if (suppressed) {
+            fprintf(stderr, "Warning: %u memory manager messages suppressed.\n", suppressed);
+        }
+    }
+
+    if (__atomic_add_fetch(&log_count, 1, __ATOMIC_RELAXED) > LOG_RATE_LIMIT) {
+        __atomic_add_fetch(&log_suppressed, 1, __ATOMIC_RELAXED);
+        return;
+    }
+
+    if (event->code == MEM_ERR_USE_AFTER_FREE || event->code == MEM_ERR_DOUBLE_FREE) {
+        fprintf(stderr, "Error: %s at %p (offset %zu), allocated at %p, freed at %p, reported at %p.\n",
+                mem_error_string(event->code), event->ptr, event->offset, event->alloc_site, event->free_site, event->site);
+    } else {
+        fprintf(stderr, "Warning: %s (%p).\n", mem_error_string(event->code), event->ptr);
+    }
+}
+
+void mem_set_error_callback(MemErrorCallback callback, void* user_data) {
+    pthread_mutex_lock(&memory_lock);
+    error_callback = callback ? callback : default_error_callback;
+    error_user_data = user_data;
+    pthread_mutex_unlock(&memory_lock);
+}
+
+// Records an event for later dispatch; events beyond EVENT_BATCH are dropped.
+// Caller must hold memory_lock.
+static MemEvent* raise_event(MemEvents* events, MemErrorCode code, void* ptr, const MemBlock* block, void* site) {
+    if (events->count == EVENT_BATCH) {
+        return NULL;
+    }
+    if (events->count == 0) {
+        // Taken under the lock, so the callback is never paired with another registration's data
+        events->callback = error_callback;
+        events->user_data = error_user_data;
+    }
+
+    MemEvent* event = &events->events[events->count++];
+    event->code = code;
+    event->ptr = ptr;
+    event->offset = 0;
+    event->alloc_site = block ? block->alloc_site : NULL;
+    event->free_site = block ? block->free_site : NULL;
+    event->site = site;
+    return event;
+}
+
+// Hands collected events to the error callback. Must be called without memory_lock.
+static void dispatch_events(const MemEvents* events) {
+    if (events->count == 0) {
+        return;
+    }
+
+    for (int i = 0; i < events->count; i++) {
+        events->callback(&events->events[i], events->user_data);
+    }
+}
+
 void mem_init(size_t pool_size) {
     pthread_mutex_lock(&memory_lock);
 
+    // A heap pool has no tags, so a mapped pool still open is closed first
+    if (pool_file) {
+        profile_clear();
+        close_pool();
+    }
+
     pool_start = malloc(pool_size);
     if (!pool_start) {
         perror("Failed to allocate memory pool");
@@ -30,7 +210,7 @@ void mem_init(size_t pool_size) {
 
     total_pool_size = pool_size;
 
-    pool_head = (MemBlock*)malloc(sizeof(MemBlock));
+    pool_head = (MemBlock*)calloc(1, sizeof(MemBlock));
     if (!pool_head) {
         perror("Failed to allocate block metadata");
         free(pool_start);
@@ -43,128 +223,786 @@ void mem_init(size_t pool_size) {
     pool_head->data_ptr = pool_start;
     pool_head->next_block = NULL;
 
+    quarantine_head = NULL;
+    quarantine_tail = NULL;
+    quarantine_bytes = 0;
+
     pthread_mutex_unlock(&memory_lock);
 }
 
-void* mem_alloc(size_t size) {
+// Writes the tag of a block of a file-backed pool. Quarantined blocks are recorded as
+// free, since a reopened pool starts with an empty quarantine. Caller must hold memory_lock.
+static void write_tag(MemBlock* block) {
+    if (pool_file == NULL) {
+        return;
+    }
+    PoolTag* tag = (PoolTag*)((char*)block->data_ptr - sizeof(PoolTag));
+    tag->size = block->block_size;
+    tag->state = (block->is_available || block->in_quarantine) ? POOL_TAG_FREE : POOL_TAG_USED;
+}
+
+static void free_block_list(void) {
+    MemBlock* current = pool_head;
+    while (current != NULL) {
+        MemBlock* next = current->next_block;
+        free(current);
+        current = next;
+    }
+    pool_head = NULL;
+}
+
+// Rebuilds the block list from the tags of a mapped pool file, merging adjacent free
+// blocks. Returns -1 if the tags do not cover the pool exactly. Caller must hold memory_lock.
+static int load_tags(void) {
+    MemBlock* last = NULL;
+    size_t offset = 0;
+    while (offset < total_pool_size) {
+        PoolTag* tag = (PoolTag*)((char*)pool_start + offset);
+        if (total_pool_size - offset < sizeof(PoolTag) || tag->size > total_pool_size - offset - sizeof(PoolTag) ||
+            (tag->state != POOL_TAG_FREE && tag->state != POOL_TAG_USED)) {
+            return -1;
+        }
+        int available = tag->state == POOL_TAG_FREE;
+
+        if (last != NULL && available && last->is_available) {
+            last->block_size += sizeof(PoolTag) + tag->size;
+            write_tag(last);
+        } else {
+            MemBlock* block = (MemBlock*)calloc(1, sizeof(MemBlock));
+            if (!block) {
+                return -1;
+            }
+            block->block_size = tag->size;
+            block->is_available = available;
+            block->data_ptr = tag + 1;
+            if (last) {
+                last->next_block = block;
+            } else {
+                pool_head = block;
+            }
+            last = block;
+        }
+        offset += sizeof(PoolTag) + tag->size;
+    }
+    return 0;
+}
+
+// Writes the header and a single free block spanning the pool. The version is
+// stored last, so a process attaching to a shared pool can wait for it.
+static void format_pool(void* map, size_t pool_size) {
+    PoolFileHeader* header = (PoolFileHeader*)map;
+    memcpy(header->magic, POOL_FILE_MAGIC, sizeof(header->magic));
+    header->tag_size = sizeof(PoolTag);
+    header->pool_size = pool_size;
+    header->base = (uintptr_t)map;
+    header->root = 0;
+    header->generation = 1;
+
+    PoolTag* tag = (PoolTag*)((char*)map + POOL_FILE_HEADER);
+    tag->size = pool_size - sizeof(PoolTag);
+    tag->state = POOL_TAG_FREE;
+
+    __atomic_store_n(&header->version, POOL_FILE_VERSION, __ATOMIC_RELEASE);
+}
+
+static int valid_header(const PoolFileHeader* header, size_t map_size) {
+    return memcmp(header->magic, POOL_FILE_MAGIC, sizeof(header->magic)) == 0 &&
+           header->version == POOL_FILE_VERSION && header->tag_size == sizeof(PoolTag) &&
+           map_size == POOL_FILE_HEADER + header->pool_size;
+}
+
+// Makes a mapped pool the current one. Caller must hold memory_lock.
+static void use_pool(void* map, size_t pool_size) {
+    pool_file = (PoolFileHeader*)map;
+    pool_start = (char*)map + POOL_FILE_HEADER;
+    total_pool_size = pool_size;
+    tag_bytes = sizeof(PoolTag);
+    quarantine_head = NULL;
+    quarantine_tail = NULL;
+    quarantine_bytes = 0;
+}
+
+static void drop_pool(void) {
+    free_block_list();
+    munmap(pool_file, POOL_FILE_HEADER + total_pool_size);
+    pool_file = NULL;
+    pool_start = NULL;
+    total_pool_size = 0;
+    tag_bytes = 0;
+    pool_shared = 0;
+    shared_generation = 0;
+}
+
+// Flushes a file-backed pool to disk, or detaches from a shared one, and unmaps it.
+// Caller must hold memory_lock.
+static void close_pool(void) {
+    // A shared pool stays in place for the other processes until it is shm_unlink'ed
+    if (!pool_shared) {
+        msync(pool_file, POOL_FILE_HEADER + total_pool_size, MS_SYNC);
+    }
+    drop_pool();
+}
+
+int mem_init_file(const char* path, size_t pool_size) {
     pthread_mutex_lock(&memory_lock);
 
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        perror("Failed to open memory pool file");
+        if (fd >= 0) {
+            close(fd);
+        }
+        pthread_mutex_unlock(&memory_lock);
+        return -1;
+    }
+
+    int reopened = st.st_size > 0;
+    PoolFileHeader header;
+    void* map;
+    if (reopened) {
+        // Map at the original address so that pointers stored in the pool stay valid
+        if (pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) || !valid_header(&header, st.st_size)) {
+            fprintf(stderr, "Failed to open memory pool file: %s is not a pool file.\n", path);
+            close(fd);
+            pthread_mutex_unlock(&memory_lock);
+            return -1;
+        }
+        pool_size = header.pool_size;
+        map = mmap((void*)(uintptr_t)header.base, POOL_FILE_HEADER + pool_size, PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_FIXED_NOREPLACE, fd, 0);
+        if (map != MAP_FAILED && map != (void*)(uintptr_t)header.base) {
+            munmap(map, POOL_FILE_HEADER + pool_size); // Kernels without MAP_FIXED_NOREPLACE take it as a hint
+            map = MAP_FAILED;
+        }
+    } else {
+        // Block sizes stay multiples of the tag size, which keeps every tag and block aligned
+        pool_size -= pool_size % sizeof(PoolTag);
+        if (pool_size < sizeof(PoolTag) || ftruncate(fd, POOL_FILE_HEADER + pool_size) != 0) {
+            fprintf(stderr, "Failed to create memory pool file %s.\n", path);
+            close(fd);
+            unlink(path);
+            pthread_mutex_unlock(&memory_lock);
+            return -1;
+        }
+        map = mmap(NULL, POOL_FILE_HEADER + pool_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd); // The mapping keeps the file open
+
+    if (map == MAP_FAILED) {
+        perror("Failed to map memory pool file");
+        pthread_mutex_unlock(&memory_lock);
+        return -1;
+    }
+
+    if (!reopened) {
+        format_pool(map, pool_size);
+    }
+    use_pool(map, pool_size);
+
+    if (load_tags() != 0) {
+        fprintf(stderr, "Failed to open memory pool file: block tags in %s are corrupt.\n", path);
+        drop_pool();
+        pthread_mutex_unlock(&memory_lock);
+        return -1;
+    }
+
+    pthread_mutex_unlock(&memory_lock);
+    return reopened;
+}
+
+int mem_init_shared(const char* name, size_t pool_size) {
+    pthread_mutex_lock(&memory_lock);
+
+    // Exactly one process creates and formats the pool; the others attach to it
+    int created = 1;
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0 && errno == EEXIST) {
+        created = 0;
+        fd = shm_open(name, O_RDWR, 0);
+    }
+    if (fd < 0) {
+        perror("Failed to open shared memory pool");
+        pthread_mutex_unlock(&memory_lock);
+        return -1;
+    }
+
+    void* map = MAP_FAILED;
+    if (created) {
+        pool_size -= pool_size % sizeof(PoolTag);
+        if (pool_size >= sizeof(PoolTag) && ftruncate(fd, POOL_FILE_HEADER + pool_size) == 0) {
+            map = mmap(NULL, POOL_FILE_HEADER + pool_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        }
+        if (map != MAP_FAILED) {
+            pthread_mutexattr_t attr;
+            pthread_mutexattr_init(&attr);
+            pthread_mutexattr_setpshared(&attr, PTHREAD_PROCESS_SHARED);
+            pthread_mutexattr_setrobust(&attr, PTHREAD_MUTEX_ROBUST);
+            pthread_mutex_init(&((PoolFileHeader*)map)->lock, &attr);
+            pthread_mutexattr_destroy(&attr);
+            format_pool(map, pool_size);
+        } else {
+            shm_unlink(name);
+        }
+    } else {
+        // Wait for the creator to size and format the pool
+        struct stat st;
+        PoolFileHeader* header = MAP_FAILED;
+        for (int i = 0; i < SHARED_ATTACH_WAIT_MS && header == MAP_FAILED; i++) {
+            if (fstat(fd, &st) == 0 && st.st_size >= POOL_FILE_HEADER) {
+                header = (PoolFileHeader*)mmap(NULL, POOL_FILE_HEADER, PROT_READ, MAP_SHARED, fd, 0);
+            } else {
+                usleep(1000);
+            }
+        }
+        for (int i = 0; i < SHARED_ATTACH_WAIT_MS && header != MAP_FAILED &&
+                        __atomic_load_n(&header->version, __ATOMIC_ACQUIRE) == 0; i++) {
+            usleep(1000);
+        }
+        if (header != MAP_FAILED && valid_header(header, st.st_size)) {
+            pool_size = header->pool_size;
+            // The creator's address is only a hint; processes exchange offsets, not pointers
+            map = mmap((void*)(uintptr_t)header->base, POOL_FILE_HEADER + pool_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED, fd, 0);
+        }
+        if (header != MAP_FAILED) {
+            munmap(header, POOL_FILE_HEADER);
+        }
+    }
+    close(fd);
+
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "Failed to %s shared memory pool %s.\n", created ? "create" : "attach to", name);
+        pthread_mutex_unlock(&memory_lock);
+        return -1;
+    }
+
+    use_pool(map, pool_size);
+    pool_shared = 1;
+    shared_generation = 0; // The block list is loaded on first use
+
+    pthread_mutex_unlock(&memory_lock);
+    return !created;
+}
+
+// Takes memory_lock and, for a shared pool, the pool's process-shared mutex. When
+// another process has changed the pool since this one last held the mutex, the local
+// block list is rebuilt from the tags.
+static void lock_pool(MemEvents* events) {
+    pthread_mutex_lock(&memory_lock);
+    if (!pool_shared) {
+        return;
+    }
+
+    if (pthread_mutex_lock(&pool_file->lock) == EOWNERDEAD) {
+        // The owner died mid-operation. Tags are written so that they always describe
+        // a valid pool, so everyone just reloads them.
+        pthread_mutex_consistent(&pool_file->lock);
+        pool_file->generation++;
+    }
+
+    if (pool_file->generation != shared_generation) {
+        profile_clear();
+        free_block_list();
+        if (load_tags() != 0) {
+            free_block_list(); // Leaves the pool unusable rather than handing out corrupt blocks
+            if (events) {
+                raise_event(events, MEM_ERR_METADATA, pool_start, NULL, NULL);
+            }
+        }
+        shared_generation = pool_file->generation;
+    }
+}
+
+// Releases the locks taken by lock_pool. changed tells other processes to reload the tags.
+static void unlock_pool(int changed) {
+    if (pool_shared) {
+        if (changed) {
+            shared_generation = ++pool_file->generation;
+        }
+        pthread_mutex_unlock(&pool_file->lock);
+    }
+    pthread_mutex_unlock(&memory_lock);
+}
+
+void mem_set_root(void* ptr) {
+    lock_pool(NULL);
+    if (pool_file) {
+        pool_file->root = ptr ? (uint64_t)((char*)ptr - (char*)pool_start) : 0;
+    }
+    unlock_pool(0);
+}
+
+void* mem_get_root(void) {
+    lock_pool(NULL);
+    void* root = (pool_file && pool_file->root) ? (char*)pool_start + pool_file->root : NULL;
+    unlock_pool(0);
+    return root;
+}
+
+size_t mem_offset(const void* ptr) {
+    return (size_t)((const char*)ptr - (const char*)pool_start);
+}
+
+void* mem_at(size_t offset) {
+    return (char*)pool_start + offset;
+}
+
+// Finds the block whose data starts at ptr. Zero-sized blocks share their address
+// with the block that follows, so an allocated block is preferred over a free one.
+// Caller must hold memory_lock.
+static MemBlock* find_block(void* ptr) {
+    MemBlock* first = NULL;
+    MemBlock* current = pool_head;
+    while (current != NULL) {
+        if (current->data_ptr == ptr) {
+            if (!current->is_available) {
+                return current;
+            }
+            if (first == NULL) {
+                first = current;
+            }
+        } else if (first != NULL) {
+            break;
+        }
+        current = current->next_block;
+    }
+    return first;
+}
+
+// First-fit allocation. Caller must hold memory_lock.
+static void* alloc_locked(size_t size, void* site, MemEvents* events) {
     MemBlock* current = pool_head;
 
+    if (pool_file) {
+        size = (size + sizeof(PoolTag) - 1) / sizeof(PoolTag) * sizeof(PoolTag);
+    }
+
     while (current != NULL) {
         if (current->is_available && current->block_size >= size) {
-            if (current->block_size > size) {
-                MemBlock* new_block = (MemBlock*)malloc(sizeof(MemBlock));
+            // In a file pool the remainder also needs room for its tag
+            if (current->block_size > size + tag_bytes) {
+                MemBlock* new_block = (MemBlock*)calloc(1, sizeof(MemBlock));
                 if (!new_block) {
-                    perror("Failed to create new block metadata");
-                    pthread_mutex_unlock(&memory_lock);
+                    raise_event(events, MEM_ERR_METADATA, current->data_ptr, NULL, site);
                     return NULL;
                 }
 
-                new_block->block_size = current->block_size - size;
+                new_block->block_size = current->block_size - size - tag_bytes;
                 new_block->is_available = 1;
-                new_block->data_ptr = (char*)current->data_ptr + size;
+                new_block->data_ptr = (char*)current->data_ptr + size + tag_bytes;
                 new_block->next_block = current->next_block;
 
                 current->block_size = size;
                 current->is_available = 0;
                 current->next_block = new_block;
+
+                // The remainder's tag goes first: a crash in between leaves a shorter free block
+                write_tag(new_block);
+                write_tag(current);
             } else {
                 current->is_available = 0;
+                write_tag(current);
             }
 
-            pthread_mutex_unlock(&memory_lock);
+            current->alloc_site = site;
+            current->free_site = NULL;
+            current->sample = NULL;
             return current->data_ptr;
         }
         current = current->next_block;
     }
 
-    pthread_mutex_unlock(&memory_lock);
     return NULL;
 }
 
+// Marks a block as available and merges it with the free blocks that follow it.
+// Caller must hold memory_lock.
+static void release_block(MemBlock* block) {
+    block->is_available = 1;
+
+    MemBlock* next_block = block->next_block;
+    while (next_block != NULL && next_block->is_available) {
+        block->block_size += tag_bytes + next_block->block_size;
+        block->next_block = next_block->next_block;
+        free(next_block);
+        next_block = block->next_block;
+    }
+    write_tag(block);
+}
+
+// Verifies the poison pattern of a quarantined block. Returns 1 if the block was
+// written to after it was freed. Caller must hold memory_lock.
+static int quarantine_check_block(MemBlock* block, MemEvents* events) {
+    const unsigned char* data = (const unsigned char*)block->data_ptr;
+    for (size_t i = 0; i < block->block_size; i++) {
+        if (data[i] != QUARANTINE_POISON) {
+            MemEvent* event = raise_event(events, MEM_ERR_USE_AFTER_FREE, block->data_ptr, block, NULL);
+            if (event) {
+                event->offset = i;
+            }
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Removes the oldest block from the quarantine, checks it and returns it to the pool.
+// Caller must hold memory_lock.
+static void quarantine_evict(MemEvents* events) {
+    MemBlock* block = quarantine_head;
+
+    quarantine_head = block->next_quarantined;
+    if (quarantine_head == NULL) {
+        quarantine_tail = NULL;
+    }
+    quarantine_bytes -= block->block_size;
+
+    quarantine_check_block(block, events);
+
+    block->in_quarantine = 0;
+    block->next_quarantined = NULL;
+    release_block(block);
+}
+
+// Poisons a freed block and appends it to the quarantine, evicting the oldest
+// blocks while the quarantine is over its limit. Caller must hold memory_lock.
+static void quarantine_push(MemBlock* block, MemEvents* events) {
+    memset(block->data_ptr, QUARANTINE_POISON, block->block_size);
+
+    block->in_quarantine = 1;
+    block->next_quarantined = NULL;
+    write_tag(block);
+    if (quarantine_tail) {
+        quarantine_tail->next_quarantined = block;
+    } else {
+        quarantine_head = block;
+    }
+    quarantine_tail = block;
+    quarantine_bytes += block->block_size;
+
+    while (quarantine_head != NULL && quarantine_bytes > quarantine_limit) {
+        quarantine_evict(events);
+    }
+}
+
+// Frees a block, routing it through the quarantine when it is enabled. Returns 0
+// if ptr is not an allocated block and nothing changed. Caller must hold memory_lock.
+static int free_locked(void* ptr, void* site, MemEvents* events) {
+    MemBlock* block = find_block(ptr);
+    if (block == NULL) {
+        raise_event(events, MEM_ERR_INVALID_FREE, ptr, NULL, site);
+        return 0;
+    }
+
+    if (block->in_quarantine || block->is_available) {
+        raise_event(events, MEM_ERR_DOUBLE_FREE, ptr, block, site);
+        return 0;
+    }
+
+    block->free_site = site;
+    if (block->sample) {
+        free(block->sample);
+        block->sample = NULL;
+    }
+    if (quarantine_limit > 0 && !pool_shared) {
+        quarantine_push(block, events);
+    } else {
+        release_block(block);
+    }
+    return 1;
+}
+
+// Draws the number of bytes until the next sample from an exponential distribution,
+// so that samples form a Poisson process over the allocated bytes.
+static double next_sample_distance(size_t interval) {
+    if (sample_rng == 0) {
+        sample_rng = (uint64_t)(uintptr_t)&sample_rng ^ 0x9E3779B97F4A7C15ULL;
+    }
+    sample_rng ^= sample_rng << 13;
+    sample_rng ^= sample_rng >> 7;
+    sample_rng ^= sample_rng << 17;
+
+    double u = ((sample_rng >> 11) + 1.0) / 9007199254740993.0; // Uniform in (0, 1)
+    return -log(u) * (double)interval;
+}
+
+// Decides whether this allocation is sampled and, if so, captures its call stack.
+// Runs before memory_lock is taken so backtraces never extend the lock hold time.
+static ProfileSample* profile_maybe_sample(size_t size) {
+    size_t interval = __atomic_load_n(&profile_interval, __ATOMIC_RELAXED);
+    if (interval == 0) {
+        return NULL;
+    }
+
+    // A thread draws its first countdown instead of sampling its first allocation
+    if (interval != sample_interval_seen) {
+        sample_interval_seen = interval;
+        bytes_until_sample = next_sample_distance(interval);
+    }
+    bytes_until_sample -= (double)size;
+    if (bytes_until_sample > 0) {
+        return NULL;
+    }
+    bytes_until_sample = next_sample_distance(interval);
+
+    ProfileSample* sample = (ProfileSample*)malloc(sizeof(ProfileSample));
+    if (!sample) {
+        return NULL;
+    }
+
+    // Skip this helper so stacks start at the mem_alloc/mem_resize frame
+    void* frames[PROFILE_MAX_DEPTH + 1];
+    int depth = backtrace(frames, PROFILE_MAX_DEPTH + 1);
+    sample->depth = depth > 1 ? depth - 1 : 0;
+    memcpy(sample->stack, frames + 1, sample->depth * sizeof(void*));
+
+    sample->size = size;
+    sample->weight = size > 0 ? (double)size / (1.0 - exp(-(double)size / (double)interval)) : 0.0;
+    return sample;
+}
+
+void* mem_alloc(size_t size) {
+    ProfileSample* sample = profile_maybe_sample(size);
+    MemEvents events = {.count = 0};
+
+    lock_pool(&events);
+
+    void* ptr = alloc_locked(size, __builtin_return_address(0), &events);
+
+    // Quarantined memory is only borrowed for detection; give it back before failing
+    while (ptr == NULL && quarantine_head != NULL) {
+        quarantine_evict(&events);
+        ptr = alloc_locked(size, __builtin_return_address(0), &events);
+    }
+
+    if (ptr && sample) {
+        find_block(ptr)->sample = sample;
+        sample = NULL;
+    }
+
+    unlock_pool(ptr != NULL);
+    dispatch_events(&events);
+    free(sample);
+    return ptr;
+}
+
 void mem_free(void* ptr) {
     if (!ptr) {
-        fprintf(stderr, "Warning: Attempted to free a NULL pointer.\n");
         return;
     }
 
-    pthread_mutex_lock(&memory_lock);
+    MemEvents events = {.count = 0};
 
-    MemBlock* current = pool_head;
-    while (current != NULL) {
-        if (current->data_ptr == ptr) {
-            if (current->is_available) {
-                fprintf(stderr, "Warning: Block at %p is already free.\n", ptr);
-                pthread_mutex_unlock(&memory_lock);
-                return;
-            }
+    lock_pool(&events);
+    int released = free_locked(ptr, __builtin_return_address(0), &events);
+    unlock_pool(released); // A rejected free leaves the other processes' block lists valid
+
+    dispatch_events(&events);
+}
+
+void* mem_resize(void* ptr, size_t size) {
+    if (!ptr) return mem_alloc(size);
+
+    MemEvents events = {.count = 0};
+    void* site = __builtin_return_address(0);
 
-            current->is_available = 1;
+    lock_pool(&events);
+
+    MemBlock* block = find_block(ptr);
+    if (block == NULL || block->is_available || block->in_quarantine) {
+        raise_event(&events, MEM_ERR_INVALID_RESIZE, ptr, block, site);
+        unlock_pool(0);
+        dispatch_events(&events);
+        return NULL;
+    }
+
+    if (block->block_size >= size) {
+        unlock_pool(0);
+        return ptr;
+    }
 
-            MemBlock* next_block = current->next_block;
-            while (next_block != NULL && next_block->is_available) {
-                current->block_size += next_block->block_size;
-                current->next_block = next_block->next_block;
-                free(next_block);
-                next_block = current->next_block;
+    unlock_pool(0);
+    ProfileSample* sample = profile_maybe_sample(size);
+    lock_pool(&events);
+
+    // The block may have been freed while the lock was dropped for sampling
+    block = find_block(ptr);
+    void* new_ptr = NULL;
+    if (block != NULL && !block->is_available && !block->in_quarantine) {
+        new_ptr = alloc_locked(size, site, &events);
+        while (new_ptr == NULL && quarantine_head != NULL) {
+            quarantine_evict(&events);
+            new_ptr = alloc_locked(size, site, &events);
+        }
+        if (new_ptr) {
+            memcpy(new_ptr, ptr, block->block_size);
+            free_locked(ptr, site, &events);
+            if (sample) {
+                find_block(new_ptr)->sample = sample;
+                sample = NULL;
             }
+        }
+    }
 
-            pthread_mutex_unlock(&memory_lock);
-            return;
+    unlock_pool(new_ptr != NULL);
+    dispatch_events(&events);
+    free(sample);
+    return new_ptr;
+}
+
+void mem_set_quarantine(size_t max_bytes) {
+    MemEvents events = {.count = 0};
+
+    pthread_mutex_lock(&memory_lock);
+
+    quarantine_limit = max_bytes;
+    while (quarantine_head != NULL && quarantine_bytes > quarantine_limit) {
+        quarantine_evict(&events);
+    }
+
+    pthread_mutex_unlock(&memory_lock);
+    dispatch_events(&events);
+}
+
+size_t mem_quarantine_check(void) {
+    MemEvents events = {.count = 0};
+
+    pthread_mutex_lock(&memory_lock);
+
+    size_t corrupted = 0;
+    for (MemBlock* block = quarantine_head; block != NULL; block = block->next_quarantined) {
+        corrupted += quarantine_check_block(block, &events);
+    }
+
+    pthread_mutex_unlock(&memory_lock);
+    dispatch_events(&events);
+    return corrupted;
+}
+
+// Frees every live sample. Caller must hold memory_lock.
+static void profile_clear(void) {
+    for (MemBlock* block = pool_head; block != NULL; block = block->next_block) {
+        free(block->sample);
+        block->sample = NULL;
+    }
+}
+
+void mem_profile_start(size_t sample_interval) {
+    pthread_mutex_lock(&memory_lock);
+    __atomic_store_n(&profile_interval, sample_interval ? sample_interval : MEM_PROFILE_DEFAULT_INTERVAL, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&memory_lock);
+}
+
+void mem_profile_stop(void) {
+    pthread_mutex_lock(&memory_lock);
+    __atomic_store_n(&profile_interval, 0, __ATOMIC_RELAXED);
+    profile_clear();
+    pthread_mutex_unlock(&memory_lock);
+}
+
+size_t mem_profile_live_bytes(void) {
+    pthread_mutex_lock(&memory_lock);
+
+    double live = 0.0;
+    for (MemBlock* block = pool_head; block != NULL; block = block->next_block) {
+        if (block->sample) {
+            live += block->sample->weight;
         }
-        current = current->next_block;
     }
 
-    fprintf(stderr, "Warning: Pointer %p was not allocated from this pool.\n", ptr);
     pthread_mutex_unlock(&memory_lock);
+    return (size_t)(live + 0.5);
 }
 
-void* mem_resize(void* ptr, size_t size) {
-    if (!ptr) return mem_alloc(size);
+static int same_stack(const ProfileSample* a, const ProfileSample* b) {
+    return a->depth == b->depth && memcmp(a->stack, b->stack, a->depth * sizeof(void*)) == 0;
+}
 
+void mem_profile_report(FILE* out) {
     pthread_mutex_lock(&memory_lock);
 
-    MemBlock* block = pool_head;
-    while (block != NULL) {
-        if (block->data_ptr == ptr) {
-            if (block->block_size >= size) {
-                pthread_mutex_unlock(&memory_lock);
-                return ptr;
+    size_t count = 0;
+    for (MemBlock* block = pool_head; block != NULL; block = block->next_block) {
+        if (block->sample) {
+            count++;
+        }
+    }
+
+    // Copy the live samples so symbolization and printing happen outside the lock
+    ProfileSample* samples = count ? (ProfileSample*)malloc(count * sizeof(ProfileSample)) : NULL;
+    if (count && !samples) {
+        pthread_mutex_unlock(&memory_lock);
+        perror("Failed to allocate heap profile report");
+        return;
+    }
+    size_t n = 0;
+    for (MemBlock* block = pool_head; block != NULL; block = block->next_block) {
+        if (block->sample) {
+            samples[n++] = *block->sample;
+        }
+    }
+    size_t interval = profile_interval;
+
+    pthread_mutex_unlock(&memory_lock);
+
+    double total = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        total += samples[i].weight;
+    }
+    fprintf(out, "Heap profile: %zu sampled allocations, ~%.0f live bytes (sample interval %zu bytes)\n", n, total, interval);
+
+    // Group samples by call stack; a group leader keeps the summed weight
+    for (size_t i = 0; i < n; i++) {
+        if (samples[i].depth < 0) {
+            continue;
+        }
+        double bytes = samples[i].weight;
+        size_t allocations = 1;
+        for (size_t j = i + 1; j < n; j++) {
+            if (samples[j].depth >= 0 && same_stack(&samples[i], &samples[j])) {
+                bytes += samples[j].weight;
+                allocations++;
+                samples[j].depth = -1;
+            }
+        }
+
+        fprintf(out, "  ~%.0f bytes in %zu sampled allocations from:\n", bytes, allocations);
+        char** symbols = backtrace_symbols(samples[i].stack, samples[i].depth);
+        for (int k = 0; k < samples[i].depth; k++) {
+            if (symbols) {
+                fprintf(out, "    %s\n", symbols[k]);
             } else {
-                void* new_ptr = mem_alloc(size);
-                if (new_ptr) {
-                    memcpy(new_ptr, ptr, block->block_size);
-                    mem_free(ptr);
-                }
-                pthread_mutex_unlock(&memory_lock);
-                return new_ptr;
+                fprintf(out, "    %p\n", samples[i].stack[k]);
             }
         }
-        block = block->next_block;
+        free(symbols);
     }
 
-    fprintf(stderr, "Warning: Resize failed, pointer %p not found.\n", ptr);
-    pthread_mutex_unlock(&memory_lock);
-    return NULL;
+    free(samples);
 }
 
 void mem_deinit() {
-    pthread_mutex_lock(&memory_lock);
+    MemEvents events = {.count = 0};
 
-    free(pool_start);
-    pool_start = NULL;
+    pthread_mutex_lock(&memory_lock);
 
-    MemBlock* current = pool_head;
-    while (current != NULL) {
-        MemBlock* next = current->next_block;
-        free(current);
-        current = next;
+    // Drain the quarantine so pending use-after-free writes are still reported
+    while (quarantine_head != NULL) {
+        quarantine_evict(&events);
     }
 
-    pool_head = NULL;
-    total_pool_size = 0;
+    profile_clear();
+
+    if (pool_file) {
+        close_pool(); // The block tags already describe the pool
+    } else {
+        free(pool_start);
+        pool_start = NULL;
+        free_block_list();
+        total_pool_size = 0;
+    }
 
     pthread_mutex_unlock(&memory_lock);
-    pthread_mutex_destroy(&memory_lock);
-}
\ No newline at end of file
+    dispatch_events(&events);
+}
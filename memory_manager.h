@@ -2,6 +2,33 @@
 #define MEMORY_MANAGER_H
 
 #include <stddef.h> // For size_t
+#include <stdio.h>  // For FILE
+
+// Mean number of allocated bytes between two heap profile samples
+#define MEM_PROFILE_DEFAULT_INTERVAL (512 * 1024)
+
+// Error codes reported to the error callback
+typedef enum MemErrorCode
+{
+    MEM_ERR_INVALID_FREE = 1, // mem_free of a pointer that was not allocated from the pool
+    MEM_ERR_DOUBLE_FREE,      // mem_free of a block that is already free or quarantined
+    MEM_ERR_INVALID_RESIZE,   // mem_resize of a pointer that is not an allocated block
+    MEM_ERR_USE_AFTER_FREE,   // A quarantined block was written to after being freed
+    MEM_ERR_METADATA          // Block metadata could not be allocated
+} MemErrorCode;
+
+// Describes one error detected by the memory manager
+typedef struct MemEvent
+{
+    MemErrorCode code;
+    void *ptr;        // The block or pointer the error refers to
+    size_t offset;    // Offset of the first corrupted byte for MEM_ERR_USE_AFTER_FREE
+    void *alloc_site; // Return address of the call that allocated the block, if known
+    void *free_site;  // Return address of the call that freed the block, if known
+    void *site;       // Return address of the call that detected the error, if known
+} MemEvent;
+
+typedef void (*MemErrorCallback)(const MemEvent *event, void *user_data);
 
 // Helps C++ compilers to handle C header filesaa
 #ifdef __cplusplus
@@ -12,12 +39,82 @@ extern "C"
     /**
      * Initializes the memory manager with a specified size of memory pool.
      * The memory pool could be any data structure, for instance, a large array
-     * or a similar contiguous block of memory.
+     * or a similar contiguous block of memory. A file-backed or shared pool that is
+     * still open is closed first, as by mem_deinit.
      *
      * @param size The size of the memory pool to initialize.
      */
     void mem_init(size_t size);
 
+    /**
+     * Initializes the memory manager with a pool that lives in a memory-mapped file,
+     * so that the pool contents and the allocator state survive the process. Every
+     * block is preceded by a 16-byte tag holding its size and state, from which the
+     * allocator rebuilds its block list when the file is reopened; allocations are
+     * rounded up to 16 bytes. Blocks left in the quarantine are free after a reopen.
+     *
+     * A reopened pool is mapped at the address it was created at, so pointers stored
+     * in the pool remain valid. Opening fails if that address range is taken.
+     * Changes reach the file through the shared mapping; mem_deinit flushes them to disk.
+     *
+     * @param path The pool file, created if it does not exist.
+     * @param size The size of a new pool, tags included. Ignored when reopening.
+     * @return 0 if a new pool was created, 1 if an existing one was reopened, -1 on error.
+     */
+    int mem_init_file(const char *path, size_t size);
+
+    /**
+     * Initializes the memory manager with a pool in POSIX shared memory that several
+     * processes allocate from and free to. The first process to call it creates the
+     * pool; the others attach to it. The pool uses the tag layout of mem_init_file
+     * and a process-shared robust mutex: when a process dies holding it, the next
+     * owner recovers the pool from the tags.
+     *
+     * Each process keeps its own copy of the block list and reloads it from the tags
+     * after another process has changed the pool, so handing blocks back and forth is
+     * cheap but many small interleaved allocations are not. The pool may be mapped at
+     * a different address in each process; exchange blocks with mem_offset and mem_at.
+     * The quarantine is not used, and heap profile samples are dropped on a reload.
+     *
+     * @param name The shared memory object name, such as "/my_pool".
+     * @param size The size of a new pool, tags included. Ignored when attaching.
+     * @return 0 if the pool was created, 1 if an existing one was attached to, -1 on error.
+     *         mem_deinit detaches; the pool lives on until shm_unlink(name).
+     */
+    int mem_init_shared(const char *name, size_t size);
+
+    /**
+     * Converts a block to its offset in the pool, which stays the same in every
+     * process that maps a shared or file-backed pool.
+     *
+     * @param ptr A pointer into the pool.
+     * @return The offset of ptr from the start of the pool.
+     */
+    size_t mem_offset(const void *ptr);
+
+    /**
+     * Converts an offset from mem_offset back to a pointer in this process.
+     *
+     * @param offset An offset into the pool.
+     * @return A pointer to the byte at offset.
+     */
+    void *mem_at(size_t offset);
+
+    /**
+     * Records a block of a file-backed or shared pool as its root, the entry point from
+     * which a reopened pool, or another process, finds its data. Has no effect on a heap pool.
+     *
+     * @param ptr A block allocated from the pool, or NULL to clear the root.
+     */
+    void mem_set_root(void *ptr);
+
+    /**
+     * Returns the root block of a file-backed or shared pool.
+     *
+     * @return The block passed to mem_set_root, or NULL if none was set or the pool is on the heap.
+     */
+    void *mem_get_root(void);
+
     /**
      * Allocates a block of memory of the specified size. This function finds a
      * suitable block in the pool, marks it as allocated, and returns a pointer
@@ -50,9 +147,79 @@ extern "C"
      * Frees up the entire memory pool that was initially allocated by mem_init.
      * This function should be called to clean up the memory manager resources before
      * the program terminates or when the memory manager is no longer needed.
+     * A file-backed pool is flushed and unmapped instead; the file is kept.
      */
     void mem_deinit();
 
+    /**
+     * Registers the callback that receives errors detected by the memory manager. The
+     * callback is always invoked after the internal lock has been released, so it may
+     * call back into the memory manager. The default callback logs to stderr with a
+     * rate limit; mem_error_callback_noop silences all reports.
+     *
+     * @param callback The callback to invoke, or NULL to restore the default logger.
+     * @param user_data Passed unchanged to every callback invocation.
+     */
+    void mem_set_error_callback(MemErrorCallback callback, void *user_data);
+
+    /**
+     * An error callback that ignores every event.
+     */
+    void mem_error_callback_noop(const MemEvent *event, void *user_data);
+
+    /**
+     * Returns a short description of an error code.
+     */
+    const char *mem_error_string(MemErrorCode code);
+
+    /**
+     * Enables the quarantine-based use-after-free detector. Freed blocks are filled
+     * with a poison pattern and held in a FIFO instead of being returned to the pool.
+     * When a block is evicted from the quarantine its poison is verified, and any write
+     * made after the free is reported together with the allocation and free call sites.
+     * Quarantined memory is released early if an allocation would otherwise fail.
+     *
+     * @param max_bytes The maximum number of bytes held in quarantine, or 0 to disable it.
+     */
+    void mem_set_quarantine(size_t max_bytes);
+
+    /**
+     * Verifies the poison pattern of every block currently in quarantine without
+     * evicting them.
+     *
+     * @return The number of quarantined blocks that were written to after being freed.
+     */
+    size_t mem_quarantine_check(void);
+
+    /**
+     * Starts the sampling heap profiler. Allocations are sampled as a Poisson process
+     * over the allocated bytes, on average once per sample_interval bytes, and the call
+     * stack of every sampled allocation is kept until the block is freed.
+     *
+     * @param sample_interval Mean bytes between samples, or 0 for MEM_PROFILE_DEFAULT_INTERVAL.
+     */
+    void mem_profile_start(size_t sample_interval);
+
+    /**
+     * Stops the heap profiler and discards all samples.
+     */
+    void mem_profile_stop(void);
+
+    /**
+     * Estimates the number of live bytes in the pool from the samples that have not been freed.
+     *
+     * @return The estimated live bytes attributed to sampled call stacks.
+     */
+    size_t mem_profile_live_bytes(void);
+
+    /**
+     * Writes the estimated live bytes per call stack for all sampled allocations that
+     * are still allocated.
+     *
+     * @param out The stream to write the report to.
+     */
+    void mem_profile_report(FILE *out);
+
 #ifdef __cplusplus
 }
 #endif
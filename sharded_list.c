@@ -0,0 +1,101 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include "sharded_list.h"
+
+// Each shard sits on its own cache lines so that the locks and counts of
+// neighbouring shards are not shared between cores.
+typedef struct Shard {
+    List list;
+} __attribute__((aligned(64))) Shard;
+
+// Fibonacci hashing spreads runs of nearby values over all shards
+static inline List* shard_of(ShardedList* list, uint16_t data) {
+    uint32_t hash = ((uint32_t)data * 2654435761u) >> 16;
+    return &list->shards[hash & (list->num_shards - 1)].list;
+}
+
+// Initializes the memory pool and the shards
+void shlist_init(ShardedList* list, size_t num_shards, size_t size) {
+    size_t count = 1;
+    while (count < num_shards) {
+        count *= 2;
+    }
+
+    list->shards = (Shard*)aligned_alloc(64, count * sizeof(Shard));
+    if (!list->shards) {
+        printf("Memory allocation failed\n");
+        list->num_shards = 0;
+        return;
+    }
+    list->num_shards = count;
+
+    mem_init(size);
+    for (size_t i = 0; i < count; i++) {
+        list_create_shared(&list->shards[i].list);
+    }
+}
+
+// Inserts a value into its shard
+void shlist_insert(ShardedList* list, uint16_t data) {
+    list_append(shard_of(list, data), data);
+}
+
+// Deletes one occurrence of the value
+void shlist_delete(ShardedList* list, uint16_t data) {
+    list_remove(shard_of(list, data), data);
+}
+
+// Searches for a node holding the value
+Node* shlist_search(ShardedList* list, uint16_t data) {
+    return list_find(shard_of(list, data), data);
+}
+
+// Sums the shard lengths; concurrent updates may or may not be included
+size_t shlist_count(ShardedList* list) {
+    size_t count = 0;
+    for (size_t i = 0; i < list->num_shards; i++) {
+        count += list_length(&list->shards[i].list);
+    }
+    return count;
+}
+
+// Counts the copies of the value, which all live in one shard
+size_t shlist_count_value(ShardedList* list, uint16_t data) {
+    return list_count_value(shard_of(list, data), data);
+}
+
+// Calls fn for every value, one shard snapshot at a time
+void shlist_foreach(ShardedList* list, void (*fn)(uint16_t data, void* arg), void* arg) {
+    uint16_t* values = NULL;
+    size_t capacity = 0;
+    for (size_t i = 0; i < list->num_shards; i++) {
+        List* shard = &list->shards[i].list;
+        size_t length = list_length(shard);
+        if (length > capacity) {
+            uint16_t* grown = (uint16_t*)realloc(values, length * sizeof(uint16_t));
+            if (!grown) {
+                printf("Memory allocation failed\n");
+                break;
+            }
+            values = grown;
+            capacity = length;
+        }
+
+        size_t count = list_to_array(shard, values, length);
+        for (size_t k = 0; k < count; k++) {
+            fn(values[k], arg);
+        }
+    }
+    free(values);
+}
+
+// Frees all shards and deallocates the memory manager
+void shlist_cleanup(ShardedList* list) {
+    for (size_t i = 0; i < list->num_shards; i++) {
+        list_destroy(&list->shards[i].list);
+    }
+    free(list->shards);
+    list->shards = NULL;
+    list->num_shards = 0;
+    mem_deinit();
+}
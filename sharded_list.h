@@ -0,0 +1,38 @@
+// sharded_list.h
+#ifndef SHARDED_LIST_H
+#define SHARDED_LIST_H
+
+#include "linked_list.h"
+
+#ifndef LIST_HANDLE_API
+#error "sharded_list.h needs the List handle of the mutex build"
+#endif
+
+// Unordered multiset of uint16_t values striped over independently locked Lists
+// that share one memory pool. A value always goes to the shard its hash selects,
+// so inserting, deleting, searching and counting a value lock a single shard, and
+// threads working on different values mostly take different locks. There is no
+// order across shards.
+typedef struct ShardedList
+{
+    struct Shard *shards;
+    size_t num_shards; // Power of two
+} ShardedList;
+
+// Initializes the memory pool with the given size and at least num_shards shards
+void shlist_init(ShardedList *list, size_t num_shards, size_t size);
+void shlist_insert(ShardedList *list, uint16_t data);
+void shlist_delete(ShardedList *list, uint16_t data);
+Node *shlist_search(ShardedList *list, uint16_t data);
+
+// Number of values in all shards, and number of copies of one value
+size_t shlist_count(ShardedList *list);
+size_t shlist_count_value(ShardedList *list, uint16_t data);
+
+// Calls fn for every value, shard by shard. Each shard is copied out first, so fn
+// may use the list; values inserted meanwhile may or may not be seen.
+void shlist_foreach(ShardedList *list, void (*fn)(uint16_t data, void *arg), void *arg);
+
+void shlist_cleanup(ShardedList *list);
+
+#endif // SHARDED_LIST_H
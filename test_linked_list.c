@@ -1,8 +1,15 @@
 #include "linked_list.h"
+#include "unrolled_list.h"
+#include "compressed_list.h"
+#ifdef LIST_HANDLE_API
+#include "sharded_list.h"
+#endif
 #include <stdio.h>
 #include <string.h>
 #include <assert.h>
 #include <time.h>
+#include <sys/time.h>
+#include <unistd.h>
 #include <stddef.h>
 #include <math.h>
 #include "common_defs.h"
@@ -644,6 +651,1899 @@ void test_list_edge_cases()
     printf_green("[PASS].\n");
 }
 
+#ifdef LIST_HANDLE_API
+// ********* List handle *********
+
+void test_list_handle_tail(int count)
+{
+    printf_yellow("  Testing list handle tail and count (nodes: %d) ---> ", count);
+    List list;
+    list_create(&list, sizeof(Node) * (count + 3));
+
+    for (int i = 0; i < count; i++)
+    {
+        list_append(&list, i);
+        my_assert(list.tail->data == i);
+    }
+    my_assert(list_length(&list) == (size_t)count);
+
+    // Inserting after the tail must move the tail
+    list_add_after(&list, list.tail, 40000);
+    my_assert(list.tail->data == 40000);
+
+    // Removing the tail must move the tail back to its predecessor
+    list_remove(&list, 40000);
+    my_assert(list.tail->data == count - 1);
+    my_assert(list.tail->next == NULL);
+
+    list_add_before(&list, list.head, 50000);
+    my_assert(list.head->data == 50000);
+    my_assert(list_length(&list) == (size_t)count + 1);
+
+    Node *current = list.head->next;
+    for (int i = 0; i < count; i++)
+    {
+        my_assert(current->data == i);
+        current = current->next;
+    }
+
+    list_destroy(&list);
+    my_assert(list.head == NULL && list.tail == NULL && list_length(&list) == 0);
+    printf_green("[PASS].\n");
+}
+
+void test_list_node_freelist(int count)
+{
+    printf_yellow("  Testing list node freelist (nodes: %d) ---> ", count);
+    List list;
+    list_create(&list, sizeof(Node) * count); // Exactly enough, so the last chunks must shrink
+
+    for (int i = 0; i < count; i++)
+        list_append(&list, i);
+    my_assert(list_length(&list) == (size_t)count && list.free_nodes == NULL);
+
+    // A removed node is recycled by the next insert
+    Node *removed = list_find(&list, count / 2);
+    list_remove_node(&list, removed);
+    list_append(&list, 60000);
+    my_assert(list.tail == removed && list.tail->data == 60000);
+
+    // Emptying and refilling the list reuses the same nodes without touching the pool
+    while (list.head != NULL)
+        list_remove_node(&list, list.head);
+    for (int i = 0; i < count; i++)
+        list_append(&list, i);
+    my_assert(list_length(&list) == (size_t)count);
+
+    // Destroying the list returns every chunk to the pool
+    list_destroy(&list);
+    my_assert(list.chunks == NULL && list.free_nodes == NULL);
+    printf_green("[PASS].\n");
+}
+
+// Checks every indexed lookup against a scan from the head
+int index_matches_scan(List *list, int num_values)
+{
+    for (int value = 0; value < num_values; value++)
+    {
+        Node *expected = list->head;
+        while (expected != NULL && expected->data != value)
+            expected = expected->next;
+        if (list_find(list, value) != expected)
+            return 0;
+    }
+    return 1;
+}
+
+Node *nth_node(List *list, size_t n)
+{
+    Node *current = list->head;
+    while (n-- > 0)
+        current = current->next;
+    return current;
+}
+
+void test_list_index(int operations)
+{
+    printf_yellow("  Testing list value index (operations: %d) ---> ", operations);
+    const int num_values = 32; // Few values, so most of them are duplicated
+    List list;
+    list_create(&list, sizeof(Node) * operations + LIST_INDEX_BYTES);
+    list_append(&list, 1);
+    list_append(&list, 2);
+    my_assert(list_index_enable(&list) == 0);
+    my_assert(index_matches_scan(&list, num_values));
+
+    for (int i = 0; i < operations; i++)
+    {
+        uint16_t value = rand() % num_values;
+        switch (rand() % 4)
+        {
+        case 0:
+            list_append(&list, value);
+            break;
+        case 1:
+            if (list.count > 0)
+                list_add_after(&list, nth_node(&list, rand() % list.count), value);
+            break;
+        case 2:
+            if (list.count > 0)
+                list_add_before(&list, nth_node(&list, rand() % list.count), value);
+            break;
+        default:
+            if (list_find(&list, value) != NULL)
+                list_remove(&list, value);
+            break;
+        }
+        if (i % 64 == 0)
+            my_assert(index_matches_scan(&list, num_values));
+    }
+    my_assert(index_matches_scan(&list, num_values));
+
+    // Removing every node through the index must leave the tail consistent
+    while (list.head != NULL)
+    {
+        list_remove(&list, list.tail->data);
+        my_assert(list.tail == NULL || list.tail->next == NULL);
+    }
+    my_assert(list_length(&list) == 0 && list.tail == NULL);
+    my_assert(index_matches_scan(&list, num_values));
+
+    list_index_disable(&list);
+    list_destroy(&list);
+
+    // The Node ** interface with an index
+    Node *head;
+    list_init_indexed(&head, sizeof(Node) * 3);
+    list_insert(&head, 7);
+    list_insert(&head, 8);
+    list_insert(&head, 9);
+    my_assert(list_search(&head, 8) == head->next);
+    list_delete(&head, 7);
+    my_assert(head->data == 8 && list_search(&head, 7) == NULL);
+    my_assert(list_count_nodes(&head) == 2);
+    list_cleanup(&head);
+
+    printf_green("[PASS].\n");
+}
+
+// Checks that walking backwards from the tail visits the same nodes as walking forwards
+int prev_links_consistent(List *list)
+{
+    Node *previous = NULL;
+    size_t count = 0;
+    for (Node *current = list->head; current != NULL; current = current->next)
+    {
+        if (current->prev != previous)
+            return 0;
+        previous = current;
+        count++;
+    }
+    return list->tail == previous && list->count == count;
+}
+
+void test_list_doubly_linked(int operations)
+{
+    printf_yellow("  Testing doubly-linked list (operations: %d) ---> ", operations);
+    List list;
+    list_create(&list, sizeof(Node) * (operations + 1));
+
+    for (int i = 0; i < operations; i++)
+    {
+        switch (rand() % 3)
+        {
+        case 0:
+            list_append(&list, i);
+            break;
+        case 1:
+            if (list.count > 0)
+                list_add_before(&list, nth_node(&list, rand() % list.count), i);
+            else
+                list_append(&list, i);
+            break;
+        default:
+            if (list.count > 0)
+                list_remove_node(&list, nth_node(&list, rand() % list.count));
+            break;
+        }
+        if (i % 64 == 0)
+            my_assert(prev_links_consistent(&list));
+    }
+    my_assert(prev_links_consistent(&list));
+
+    // Inserting before the head and removing the head and tail by node
+    list_append(&list, 60001);
+    list_add_before(&list, list.head, 60000);
+    my_assert(list.head->data == 60000 && list.head->prev == NULL);
+    list_remove_node(&list, list.head);
+    list_remove_node(&list, list.tail);
+    my_assert(prev_links_consistent(&list));
+    while (list.tail != NULL)
+        list_remove_node(&list, list.tail);
+    my_assert(list.head == NULL && list_length(&list) == 0);
+
+    list_destroy(&list);
+
+    // The Node ** interface keeps the prev pointers too
+    Node *head;
+    list_init(&head, sizeof(Node) * 3);
+    list_insert(&head, 10);
+    list_insert(&head, 20);
+    list_insert_before(&head, head->next, 15);
+    my_assert(head->next->data == 15 && head->next->prev == head);
+    my_assert(head->next->next->prev == head->next);
+    list_cleanup(&head);
+
+    printf_green("[PASS].\n");
+}
+
+void test_list_bulk(int count)
+{
+    printf_yellow("  Testing list bulk operations (values: %d) ---> ", count);
+    uint16_t *values = malloc(sizeof(uint16_t) * count * 2);
+    uint16_t *out = malloc(sizeof(uint16_t) * count * 2);
+    for (int i = 0; i < count * 2; i++)
+        values[i] = rand() % 65536;
+
+    List list;
+    my_assert(list_from_array(&list, sizeof(Node) * count * 2, values, count) == (size_t)count);
+    my_assert(list_to_array(&list, out, count * 2) == (size_t)count);
+    my_assert(memcmp(values, out, sizeof(uint16_t) * count) == 0);
+
+    // Appending after single inserts keeps the order and the links intact
+    list_append(&list, values[count]);
+    my_assert(list_insert_many(&list, values + count + 1, count - 1) == (size_t)count - 1);
+    my_assert(list_length(&list) == (size_t)count * 2 && list.tail->data == values[count * 2 - 1]);
+    my_assert(prev_links_consistent(&list));
+    my_assert(list_to_array(&list, out, count * 2) == (size_t)count * 2);
+    my_assert(memcmp(values, out, sizeof(uint16_t) * count * 2) == 0);
+
+    // Copying stops at max, and appending stops when the pool is full
+    my_assert(list_to_array(&list, out, 3) == 3 && memcmp(values, out, sizeof(uint16_t) * 3) == 0);
+    my_assert(list_insert_many(&list, values, 1) == 0);
+    my_assert(list_length(&list) == (size_t)count * 2);
+
+    list_destroy(&list);
+    free(values);
+    free(out);
+    printf_green("[PASS].\n");
+}
+
+void test_list_format(int count)
+{
+    printf_yellow("  Testing list_format and buffered display (nodes: %d) ---> ", count);
+    size_t size = count * 7 + 3;
+    char *expected = malloc(size);
+    char *buffer = malloc(size);
+    size_t length = snprintf(expected, size, "[");
+
+    List list;
+    list_create(&list, sizeof(Node) * count);
+    for (int i = 0; i < count; i++)
+    {
+        uint16_t value = rand() % 65536;
+        list_append(&list, value);
+        length += snprintf(expected + length, size - length, i ? ", %u" : "%u", value);
+    }
+    length += snprintf(expected + length, size - length, "]");
+
+    my_assert(list_format(&list, NULL, 0) == length);
+    my_assert(list_format(&list, buffer, size) == length && strcmp(buffer, expected) == 0);
+
+    // Truncated like snprintf
+    my_assert(list_format(&list, buffer, 6) == length && strlen(buffer) == 5);
+    my_assert(strncmp(buffer, expected, 5) == 0);
+    list_destroy(&list);
+
+    // The Node ** display goes through the same formatter
+    Node *head;
+    list_init(&head, sizeof(Node) * 3);
+    list_insert(&head, 0);
+    list_insert(&head, 65535);
+    list_insert(&head, 42);
+    memset(buffer, 0, size); // capture_stdout does not terminate what it reads
+    capture_stdout(buffer, size, list_display_range, &head, NULL, NULL);
+    my_assert(strcmp(buffer, "[0, 65535, 42]") == 0);
+    memset(buffer, 0, size);
+    capture_stdout(buffer, size, list_display_range, &head, head->next, head->next);
+    my_assert(strcmp(buffer, "[65535]") == 0);
+    list_cleanup(&head);
+
+    free(expected);
+    free(buffer);
+    printf_green("[PASS].\n");
+}
+
+// Checks list_at against a walk from the head for every position, and one past the end
+int positions_match(List *list)
+{
+    size_t index = 0;
+    for (Node *current = list->head; current != NULL; current = current->next)
+        if (list_at(list, index++) != current)
+            return 0;
+    return list_at(list, index) == NULL;
+}
+
+void test_list_positions(int count)
+{
+    printf_yellow("  Testing positional access (nodes: %d) ---> ", count);
+    List list;
+    list_create(&list, sizeof(Node) * (count + 3));
+    my_assert(list_at(&list, 0) == NULL);
+    for (int i = 0; i < count; i++)
+        list_append(&list, i);
+    my_assert(positions_match(&list));
+
+    // Appends keep the checkpoints; inserts and removals anywhere shift the positions
+    list_append(&list, 1);
+    my_assert(positions_match(&list));
+    list_add_before(&list, list.head, 2);
+    my_assert(positions_match(&list));
+    list_add_after(&list, list_at(&list, count / 2), 3);
+    my_assert(positions_match(&list));
+    list_remove_node(&list, list_at(&list, count / 3));
+    my_assert(positions_match(&list));
+    for (int i = 0; i < 130; i++) // Tail removals across a checkpoint
+        list_remove_node(&list, list.tail);
+    my_assert(positions_match(&list));
+
+    // A slice prints positions start to end inclusive, clamped to the list
+    char buffer[64] = {0};
+    FILE *fp = tmpfile();
+    FILE *original = stdout;
+    stdout = fp;
+    list_print_slice(&list, 1, 3);
+    list_print_slice(&list, list_length(&list) - 1, list_length(&list) + 5);
+    list_print_slice(&list, list_length(&list), list_length(&list) + 5);
+    fflush(stdout);
+    stdout = original;
+    rewind(fp);
+    fread(buffer, 1, sizeof(buffer) - 1, fp);
+    fclose(fp);
+    char expected[64];
+    snprintf(expected, sizeof(expected), "[0, 1, %u][%u][]", list_at(&list, 3)->data, list.tail->data);
+    my_assert(strcmp(buffer, expected) == 0);
+
+    // Pops and pushes at the head move the checkpoints instead of dropping them
+    for (int i = 0; i < 200; i++)
+    {
+        list_remove_node(&list, list.head);
+        if (i % 50 == 0)
+            my_assert(positions_match(&list));
+    }
+    my_assert(list.checkpoints_valid > 1 && positions_match(&list));
+    for (int i = 0; i < 200; i++)
+    {
+        list_add_before(&list, list.head, i);
+        if (i % 50 == 0)
+            my_assert(positions_match(&list));
+    }
+    my_assert(list.checkpoints_valid > 1 && positions_match(&list));
+
+    // An edit in the middle keeps the checkpoints before it
+    list_remove_node(&list, list_at(&list, count / 2));
+    my_assert(list.checkpoints_valid > (size_t)count / 4 / 64 && positions_match(&list));
+    list_add_after(&list, list_at(&list, count / 2), 4);
+    my_assert(list.checkpoints_valid > (size_t)count / 4 / 64 && positions_match(&list));
+    for (int i = 0; i < 200; i++)
+    {
+        if (i % 2)
+            list_add_before(&list, list_at(&list, (size_t)(i * 53) % list_length(&list)), i);
+        else
+            list_remove_node(&list, list_at(&list, (size_t)(i * 37) % list_length(&list)));
+        if (i % 40 == 0)
+            my_assert(positions_match(&list));
+    }
+    my_assert(positions_match(&list));
+
+    list_destroy(&list);
+    printf_green("[PASS].\n");
+}
+
+int list_is_sorted(List *list)
+{
+    for (Node *current = list->head; current != NULL && current->next != NULL; current = current->next)
+        if (current->data > current->next->data)
+            return 0;
+    return 1;
+}
+
+// Checks list_find and list_seek against a scan over every value in [0, limit)
+int sorted_lookups_match(List *list, int limit)
+{
+    for (int value = 0; value < limit; value++)
+    {
+        Node *first = list->head;
+        while (first != NULL && first->data < value)
+            first = first->next;
+        if (list_seek(list, value) != first)
+            return 0;
+        if (list_find(list, value) != (first != NULL && first->data == value ? first : NULL))
+            return 0;
+    }
+    return 1;
+}
+
+void test_list_iterator(int count)
+{
+    printf_yellow("  Testing list iterator (nodes: %d) ---> ", count);
+    List list;
+    list_create(&list, sizeof(Node) * count);
+    ListIter iter;
+    list_iter_begin(&list, &iter);
+    my_assert(list_iter_next(&iter) == NULL);
+    list_iter_end(&iter);
+
+    uint16_t *values = malloc(sizeof(uint16_t) * count);
+    for (int n = 1; n <= count; n *= 2) // Lengths around the prefetch window
+    {
+        while (list_length(&list) < (size_t)n)
+            list_append(&list, rand() % 65536);
+        list_to_array(&list, values, n);
+
+        int i = 0;
+        list_iter_begin(&list, &iter);
+        for (Node *node = list_iter_next(&iter); node != NULL; node = list_iter_next(&iter))
+        {
+            my_assert(i < n && node->data == values[i]);
+            // Read functions may run inside an iteration
+            my_assert(list_find(&list, node->data) != NULL);
+            i++;
+        }
+        my_assert(list_iter_next(&iter) == NULL);
+        list_iter_end(&iter);
+        my_assert(i == n);
+    }
+
+    free(values);
+    list_destroy(&list);
+    printf_green("[PASS].\n");
+}
+
+void test_list_snapshot(int count)
+{
+    printf_yellow("  Testing list snapshots (nodes: %d) ---> ", count);
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/test_linked_list_%d.snapshot", (int)getpid());
+    uint16_t *values = malloc(sizeof(uint16_t) * count);
+    uint16_t *loaded = malloc(sizeof(uint16_t) * count * 2);
+
+    List list;
+    list_create(&list, sizeof(Node) * count);
+    for (int i = 0; i < count; i++)
+        list_append(&list, values[i] = rand() % 65536);
+    my_assert(list_save(&list, path) == 0);
+    list_destroy(&list);
+
+    // Loading appends to whatever the list holds
+    list_create(&list, sizeof(Node) * count * 2);
+    my_assert(list_load(&list, path) == 0);
+    my_assert(list_load(&list, path) == 0);
+    my_assert(list_to_array(&list, loaded, count * 2) == (size_t)count * 2);
+    my_assert(memcmp(loaded, values, count * sizeof(uint16_t)) == 0);
+    my_assert(memcmp(loaded + count, values, count * sizeof(uint16_t)) == 0);
+    my_assert(prev_links_consistent(&list));
+    list_destroy(&list);
+
+    ListView view;
+    my_assert(list_view_open(&view, path) == 0);
+    my_assert(view.count == (size_t)count && memcmp(view.values, values, count * sizeof(uint16_t)) == 0);
+    list_view_close(&view);
+
+    // An empty list round-trips
+    list_create(&list, sizeof(Node));
+    my_assert(list_save(&list, path) == 0);
+    my_assert(list_load(&list, path) == 0 && list_length(&list) == 0);
+    list_destroy(&list);
+
+    // Truncated, padded and missing files are rejected
+    list_create(&list, sizeof(Node) * count);
+    for (int i = 0; i < count; i++)
+        list_append(&list, i);
+    list_save(&list, path);
+    FILE *file = fopen(path, "ab");
+    fputc(0, file);
+    fclose(file);
+    my_assert(list_view_open(&view, path) == -1 && view.values == NULL);
+    list_save(&list, path);
+    my_assert(truncate(path, sizeof(uint16_t) * count) == 0);
+    my_assert(list_load(&list, path) == -1);
+    my_assert(list_view_open(&view, path) == -1 && view.values == NULL);
+    remove(path);
+    my_assert(list_load(&list, path) == -1);
+    my_assert(list_length(&list) == (size_t)count);
+    list_destroy(&list);
+
+    free(values);
+    free(loaded);
+    printf_green("[PASS].\n");
+}
+
+void test_list_sort(int count)
+{
+    printf_yellow("  Testing list sorts (nodes: %d) ---> ", count);
+    Node **before = malloc(sizeof(Node *) * count);
+    Node **expected = malloc(sizeof(Node *) * count);
+    for (int method = 0; method < 4; method++) // The last one asks for no threads
+    {
+        List list;
+        list_create(&list, sizeof(Node) * count + LIST_INDEX_BYTES);
+        for (int i = 0; i < count; i++)
+            list_append(&list, rand() % (count / 4)); // Plenty of equal values
+        if (method == 2)
+            list_index_enable(&list);
+
+        // Stable order: nodes grouped by value, equal values in their old order
+        int i = 0;
+        for (Node *current = list.head; current != NULL; current = current->next)
+            before[i++] = current;
+        int *starts = calloc(count / 4 + 1, sizeof(int));
+        for (i = 0; i < count; i++)
+            starts[before[i]->data + 1]++;
+        for (int value = 0; value < count / 4; value++)
+            starts[value + 1] += starts[value];
+        for (i = 0; i < count; i++)
+            expected[starts[before[i]->data]++] = before[i];
+        free(starts);
+
+        if (method == 0)
+            list_sort(&list);
+        else if (method == 1)
+            list_sort_parallel(&list, 4);
+        else if (method == 2)
+            list_sort_radix(&list);
+        else
+            list_sort_parallel(&list, -1);
+
+        i = 0;
+        for (Node *current = list.head; current != NULL && i < count; current = current->next)
+            my_assert(current == expected[i++]);
+        my_assert(i == count);
+        my_assert(prev_links_consistent(&list));
+        my_assert(list_at(&list, count / 2) == expected[count / 2]);
+        my_assert(sorted_lookups_match(&list, count / 4));
+        list_destroy(&list);
+    }
+    free(before);
+    free(expected);
+    printf_green("[PASS].\n");
+}
+
+void test_list_compact(int count)
+{
+    printf_yellow("  Testing list compaction (nodes: %d) ---> ", count);
+    uint16_t *before = malloc(sizeof(uint16_t) * count);
+    uint16_t *after = malloc(sizeof(uint16_t) * count);
+
+    // Appends lay the nodes out in list order, so a new list needs no compaction
+    List fresh;
+    for (int i = 0; i < count; i++)
+        before[i] = i;
+    my_assert(list_from_array(&fresh, sizeof(Node) * count + 65536, before, count) == (size_t)count);
+    my_assert(list_locality(&fresh) == 1.0);
+    list_destroy(&fresh);
+    list_create(&fresh, sizeof(Node) * count + 65536);
+    for (int i = 0; i < count; i++)
+        list_append(&fresh, i);
+    my_assert(list_locality(&fresh) > 0.95); // Only the links between chunks jump
+    list_destroy(&fresh);
+
+    for (int mode = 0; mode < 3; mode++) // Plain, with the value index, in sorted mode
+    {
+        List list;
+        list_create(&list, sizeof(Node) * count * 3 + LIST_INDEX_BYTES + 65536);
+        if (mode == 1)
+            list_index_enable(&list);
+        if (mode == 2)
+            list_sorted_enable(&list);
+        for (int i = 0; i < count; i++)
+            list_append(&list, rand() % (count / 2));
+
+        // Churn so that list order and memory order drift apart
+        for (int i = 0; i < count; i++)
+        {
+            list_remove_node(&list, list_at(&list, rand() % list_length(&list)));
+            if (mode == 2)
+                list_append(&list, rand() % (count / 2));
+            else
+                list_add_after(&list, list_at(&list, rand() % list_length(&list)), rand() % (count / 2));
+        }
+        size_t length = list_to_array(&list, before, count);
+        my_assert(list_locality(&list) < 0.5);
+
+        my_assert(list_compact(&list) == 0);
+        my_assert(list_to_array(&list, after, count) == length);
+        my_assert(memcmp(before, after, length * sizeof(uint16_t)) == 0);
+        my_assert(list_locality(&list) == 1.0);
+        my_assert(prev_links_consistent(&list));
+        my_assert(sorted_lookups_match(&list, count / 2) || mode != 2);
+        my_assert(list_at(&list, length - 1) == list.tail);
+        for (int value = 0; value < count / 2; value++)
+        {
+            Node *found = list_find(&list, value);
+            my_assert(found == NULL || found->data == value);
+        }
+
+        // The list keeps working on the new nodes
+        list_append(&list, 1);
+        list_remove(&list, 1);
+        my_assert(list_length(&list) == length);
+        list_destroy(&list);
+    }
+
+    // Without room for the copy the list is left alone
+    List list;
+    list_create(&list, sizeof(Node) * count);
+    for (int i = 0; i < count; i++)
+        list_append(&list, i);
+    my_assert(list_compact(&list) == -1);
+    my_assert(list_length(&list) == (size_t)count && list.tail->data == count - 1);
+    list_destroy(&list);
+
+    free(before);
+    free(after);
+    printf_green("[PASS].\n");
+}
+
+void test_list_sorted(int count)
+{
+    printf_yellow("  Testing sorted list mode (values: %d) ---> ", count);
+    const int limit = count / 2; // Values repeat, so equal runs are exercised
+    List list;
+    list_create(&list, sizeof(Node) * count * 2 + 4096);
+
+    // Enabling needs a sorted list
+    list_append(&list, 2);
+    list_append(&list, 1);
+    my_assert(list_sorted_enable(&list) == -1);
+    list_remove(&list, 2);
+    my_assert(list_sorted_enable(&list) == 0);
+
+    for (int i = 0; i < count; i++)
+        list_append(&list, rand() % limit);
+    my_assert(list_is_sorted(&list) && list_length(&list) == (size_t)count + 1);
+    my_assert(prev_links_consistent(&list));
+    my_assert(sorted_lookups_match(&list, limit + 1));
+
+    // Positional inserts are rejected
+    list_add_after(&list, list.head, 0);
+    list_add_before(&list, list.head, 65535);
+    my_assert(list_length(&list) == (size_t)count + 1);
+
+    // Removing by value and by node keeps the towers in step
+    for (int i = 0; i < count / 2; i++)
+    {
+        Node *node = list_seek(&list, rand() % limit);
+        if (i % 2)
+            list_remove(&list, rand() % limit);
+        else
+            list_remove_node(&list, node ? node : list.head);
+    }
+    my_assert(list_is_sorted(&list) && prev_links_consistent(&list));
+    my_assert(sorted_lookups_match(&list, limit + 1));
+
+    // Bulk inserts go in order too, and the towers can be rebuilt over the result
+    uint16_t values[64];
+    for (int i = 0; i < 64; i++)
+        values[i] = rand() % limit;
+    my_assert(list_insert_many(&list, values, 64) == 64);
+    list_sorted_disable(&list);
+    my_assert(list_sorted_enable(&list) == 0);
+    my_assert(list_is_sorted(&list) && sorted_lookups_match(&list, limit + 1));
+
+    list_sorted_disable(&list);
+    list_destroy(&list);
+    printf_green("[PASS].\n");
+}
+
+typedef struct
+{
+    List *list;
+    int num_values; // The list only ever holds values below this
+    int iterations;
+    int *stop;
+    int failures;
+} ReaderParams;
+
+void *thread_reader_function(void *arg)
+{
+    ReaderParams *params = (ReaderParams *)arg;
+    uint16_t *out = malloc(sizeof(uint16_t) * params->num_values);
+    for (int i = 0; i < params->iterations || !__atomic_load_n(params->stop, __ATOMIC_ACQUIRE); i++)
+    {
+        uint16_t value = rand() % params->num_values;
+        Node *found = list_find(params->list, value);
+        if (found != NULL && found->data != value)
+            params->failures++;
+        if (list_length(params->list) > (size_t)params->num_values)
+            params->failures++;
+
+        // A full walk must end, and only see values that were inserted
+        size_t count = list_to_array(params->list, out, params->num_values);
+        for (size_t k = 0; k < count; k++)
+            if (out[k] >= params->num_values)
+                params->failures++;
+
+        // So must an iteration, and its nodes stay readable until it ends
+        ListIter iter;
+        list_iter_begin(params->list, &iter);
+        for (Node *node = list_iter_next(&iter); node != NULL; node = list_iter_next(&iter))
+            if (node->data >= params->num_values)
+                params->failures++;
+        list_iter_end(&iter);
+    }
+    free(out);
+    return NULL;
+}
+
+void test_list_concurrent_readers(int num_readers, int num_values)
+{
+    printf_yellow("  Testing lock-free readers against a writer (readers: %d, values: %d) ---> ", num_readers, num_values);
+    List list;
+    list_create(&list, sizeof(Node) * num_values * 2);
+    for (int i = 0; i < num_values; i++)
+        list_append(&list, i);
+
+    int stop = 0;
+    pthread_t threads[num_readers];
+    ReaderParams params[num_readers];
+    for (int i = 0; i < num_readers; i++)
+    {
+        params[i] = (ReaderParams){.list = &list, .num_values = num_values, .iterations = 200, .stop = &stop};
+        pthread_create(&threads[i], NULL, thread_reader_function, &params[i]);
+    }
+
+    // Keep moving values around so nodes are retired and recycled under the readers
+    for (int i = 0; i < num_values * 8; i++)
+    {
+        uint16_t value = rand() % num_values;
+        list_remove(&list, value);
+        if (i % 2)
+            list_append(&list, value);
+        else
+            list_add_before(&list, list.head, value);
+    }
+    __atomic_store_n(&stop, 1, __ATOMIC_RELEASE);
+
+    int failures = 0;
+    for (int i = 0; i < num_readers; i++)
+    {
+        pthread_join(threads[i], NULL);
+        failures += params[i].failures;
+    }
+    my_assert(failures == 0);
+    my_assert(list_length(&list) == (size_t)num_values);
+    my_assert(prev_links_consistent(&list));
+
+    list_destroy(&list);
+    printf_green("[PASS].\n");
+}
+
+// Looks up values that never leave the list; every lookup must find its value
+void *thread_present_reader_function(void *arg)
+{
+    ReaderParams *params = (ReaderParams *)arg;
+    while (!__atomic_load_n(params->stop, __ATOMIC_ACQUIRE))
+    {
+        uint16_t value = rand() % params->num_values;
+        Node *found = list_find(params->list, value);
+        if (found == NULL || found->data != value)
+            params->failures++;
+    }
+    return NULL;
+}
+
+/*
+ * Compaction rebuilds the value index under lock-free readers. Readers must keep
+ * finding every value, both when the new index is built next to the old one and
+ * when the pool only has room for one and it is rebuilt in place.
+ */
+void test_list_index_readers(int num_readers, int num_values)
+{
+    printf_yellow("  Testing index lookups during compaction (readers: %d, values: %d) ---> ", num_readers, num_values);
+    for (int room = 1; room <= 2; room++) // Indexes the pool can hold
+    {
+        List list;
+        list_create(&list, sizeof(Node) * num_values * 3 + LIST_INDEX_BYTES * room + 65536);
+        list_index_enable(&list);
+        for (int i = 0; i < num_values; i++)
+            list_append(&list, i);
+
+        int stop = 0;
+        pthread_t threads[num_readers];
+        ReaderParams params[num_readers];
+        for (int i = 0; i < num_readers; i++)
+        {
+            params[i] = (ReaderParams){.list = &list, .num_values = num_values, .stop = &stop};
+            pthread_create(&threads[i], NULL, thread_present_reader_function, &params[i]);
+        }
+
+        for (int i = 0; i < 256; i++)
+            my_assert(list_compact(&list) == 0);
+        __atomic_store_n(&stop, 1, __ATOMIC_RELEASE);
+
+        int failures = 0;
+        for (int i = 0; i < num_readers; i++)
+        {
+            pthread_join(threads[i], NULL);
+            failures += params[i].failures;
+        }
+        my_assert(failures == 0);
+        list_destroy(&list);
+    }
+    printf_green("[PASS].\n");
+}
+
+void *thread_slice_reader_function(void *arg)
+{
+    ReaderParams *params = (ReaderParams *)arg;
+    while (!__atomic_load_n(params->stop, __ATOMIC_ACQUIRE))
+    {
+        size_t start = rand() % params->num_values;
+        list_print_slice(params->list, start, start + 8);
+        if (list_at(params->list, start) == NULL)
+            params->failures++;
+    }
+    return NULL;
+}
+
+/*
+ * Sorting and compaction wait for readers to leave their read sections while they
+ * hold the list lock. Slicing and positional lookups take that lock, so they must
+ * never wait for it inside a read section.
+ */
+void test_list_slice_writers(int num_readers, int num_values)
+{
+    printf_yellow("  Testing slices during sorts and compaction (readers: %d, values: %d) ---> ", num_readers, num_values);
+    List list;
+    list_create(&list, sizeof(Node) * num_values * 3 + LIST_INDEX_BYTES * 2 + 65536);
+    list_index_enable(&list);
+    for (int i = 0; i < num_values; i++)
+        list_append(&list, rand() % 65536);
+
+    FILE *original = stdout;
+    stdout = fopen("/dev/null", "w");
+    int stop = 0;
+    pthread_t threads[num_readers];
+    ReaderParams params[num_readers];
+    for (int i = 0; i < num_readers; i++)
+    {
+        params[i] = (ReaderParams){.list = &list, .num_values = num_values, .stop = &stop};
+        pthread_create(&threads[i], NULL, thread_slice_reader_function, &params[i]);
+    }
+
+    for (int i = 0; i < 128; i++)
+    {
+        if (i % 2)
+            my_assert(list_compact(&list) == 0);
+        else
+            list_sort(&list);
+    }
+    __atomic_store_n(&stop, 1, __ATOMIC_RELEASE);
+
+    int failures = 0;
+    for (int i = 0; i < num_readers; i++)
+    {
+        pthread_join(threads[i], NULL);
+        failures += params[i].failures;
+    }
+    fclose(stdout);
+    stdout = original;
+    my_assert(failures == 0);
+    list_destroy(&list);
+    printf_green("[PASS].\n");
+}
+
+typedef struct
+{
+    List *lists;
+    int first;      // Index of the first list this thread owns
+    int step;       // Distance between the lists it owns
+    int num_lists;
+    int num_values; // Values appended to each list
+    int failures;
+} InstanceParams;
+
+void *thread_instance_function(void *arg)
+{
+    InstanceParams *params = (InstanceParams *)arg;
+    uint16_t *out = malloc(sizeof(uint16_t) * params->num_values);
+    for (int l = params->first; l < params->num_lists; l += params->step)
+    {
+        List *list = &params->lists[l];
+        if (l % 2)
+            list_sorted_enable(list); // Towers come from the shared pool too
+        for (int i = 0; i < params->num_values; i++)
+            list_append(list, i);
+        for (int i = 0; i < params->num_values; i += 2)
+            list_remove(list, i);
+
+        size_t count = list_to_array(list, out, params->num_values);
+        if (count != (size_t)params->num_values / 2)
+            params->failures++;
+        for (size_t k = 0; k < count; k++)
+            if (out[k] != 2 * k + 1)
+                params->failures++;
+    }
+    free(out);
+    return NULL;
+}
+
+void test_list_instances(int num_lists, int num_threads, int num_values)
+{
+    printf_yellow("  Testing independent lists on a shared pool (lists: %d, threads: %d) ---> ", num_lists, num_threads);
+    mem_init(sizeof(Node) * num_lists * num_values * 2);
+    mem_profile_start(1); // Sample every allocation
+    List *lists = malloc(sizeof(List) * num_lists);
+    for (int l = 0; l < num_lists; l++)
+        list_create_shared(&lists[l]);
+
+    pthread_t threads[num_threads];
+    InstanceParams params[num_threads];
+    for (int i = 0; i < num_threads; i++)
+    {
+        params[i] = (InstanceParams){.lists = lists, .first = i, .step = num_threads, .num_lists = num_lists, .num_values = num_values};
+        pthread_create(&threads[i], NULL, thread_instance_function, &params[i]);
+    }
+    int failures = 0;
+    for (int i = 0; i < num_threads; i++)
+    {
+        pthread_join(threads[i], NULL);
+        failures += params[i].failures;
+    }
+    my_assert(failures == 0);
+
+    // Destroying the lists hands every block back but leaves the pool in place
+    my_assert(mem_profile_live_bytes() > 0);
+    for (int l = 0; l < num_lists; l++)
+        list_destroy(&lists[l]);
+    my_assert(mem_profile_live_bytes() == 0);
+    my_assert(mem_alloc(sizeof(Node)) != NULL);
+    mem_profile_stop();
+
+    free(lists);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// ********* Sharded list *********
+
+typedef struct
+{
+    ShardedList *list;
+    int num_values;
+    int delete_odd; // Whether this pass deletes the odd values instead of inserting
+} ShardedParams;
+
+void *thread_sharded_function(void *arg)
+{
+    ShardedParams *params = (ShardedParams *)arg;
+    for (int i = 0; i < params->num_values; i++)
+    {
+        if (!params->delete_odd)
+            shlist_insert(params->list, i);
+        else if (i % 2)
+            shlist_delete(params->list, i);
+    }
+    return NULL;
+}
+
+void sum_values(uint16_t data, void *arg)
+{
+    ((size_t *)arg)[0]++;
+    ((size_t *)arg)[1] += data;
+}
+
+void test_sharded_list(int num_threads, int num_values)
+{
+    printf_yellow("  Testing sharded list (threads: %d, values: %d) ---> ", num_threads, num_values);
+    ShardedList list;
+    shlist_init(&list, 16, sizeof(Node) * num_threads * num_values * 2);
+
+    // Every thread inserts every value, then deletes one copy of each odd value
+    pthread_t threads[num_threads];
+    ShardedParams params = {.list = &list, .num_values = num_values};
+    for (int pass = 0; pass < 2; pass++)
+    {
+        params.delete_odd = pass;
+        for (int i = 0; i < num_threads; i++)
+            pthread_create(&threads[i], NULL, thread_sharded_function, &params);
+        for (int i = 0; i < num_threads; i++)
+            pthread_join(threads[i], NULL);
+    }
+
+    my_assert(shlist_count(&list) == (size_t)num_threads * num_values / 2);
+    for (int i = 0; i < num_values; i++)
+    {
+        my_assert(shlist_count_value(&list, i) == (i % 2 ? 0 : (size_t)num_threads));
+        Node *found = shlist_search(&list, i);
+        my_assert(i % 2 ? found == NULL : found != NULL && found->data == i);
+    }
+
+    size_t totals[2] = {0, 0};
+    shlist_foreach(&list, sum_values, totals);
+    my_assert(totals[0] == (size_t)num_threads * num_values / 2);
+    my_assert(totals[1] == (size_t)num_threads * (num_values / 2) * (num_values / 2 - 1));
+
+    shlist_cleanup(&list);
+    printf_green("[PASS].\n");
+}
+#endif
+
+// ********* Unrolled list *********
+
+// Checks that the unrolled list holds exactly the expected values in order
+int unrolled_matches(UnrolledList *list, const uint16_t *expected, size_t count)
+{
+    size_t i = 0;
+    for (UnrolledNode *node = list->head; node != NULL; node = node->next)
+    {
+        if (node->count == 0 || node->count > ULIST_NODE_CAPACITY)
+            return 0;
+        for (int k = 0; k < node->count; k++, i++)
+        {
+            if (i >= count || node->values[k] != expected[i])
+                return 0;
+        }
+    }
+    return i == count && ulist_count_nodes(list) == count;
+}
+
+void test_unrolled_list(int count)
+{
+    printf_yellow("  Testing unrolled list (values: %d) ---> ", count);
+    UnrolledList list;
+    ulist_init(&list, sizeof(UnrolledNode) * (count / 2 + 4));
+    uint16_t *expected = malloc(sizeof(uint16_t) * (count + 1));
+
+    for (int i = 0; i < count; i++)
+    {
+        ulist_insert(&list, i);
+        expected[i] = i;
+    }
+    my_assert(unrolled_matches(&list, expected, count));
+
+    // Search and insert after a value in the middle of a full node, forcing a split
+    UListPos pos = ulist_search(&list, 40);
+    my_assert(pos.node != NULL && pos.node->values[pos.index] == 40);
+    my_assert(ulist_search(&list, 60000).node == NULL);
+    ulist_insert_after(&list, pos, 60000);
+    memmove(expected + 42, expected + 41, sizeof(uint16_t) * (count - 41));
+    expected[41] = 60000;
+    my_assert(unrolled_matches(&list, expected, count + 1));
+
+    // Delete everything except the inserted value
+    for (int i = 0; i < count; i++)
+    {
+        ulist_delete(&list, i);
+    }
+    expected[0] = 60000;
+    my_assert(unrolled_matches(&list, expected, 1));
+    my_assert(list.head == list.tail);
+
+    ulist_delete(&list, 60000);
+    my_assert(list.head == NULL && list.tail == NULL);
+
+    free(expected);
+    ulist_cleanup(&list);
+    printf_green("[PASS].\n");
+}
+
+// Checks that the SIMD and scalar node scans agree on search and count over random values
+void test_unrolled_simd(int count)
+{
+    printf_yellow("  Testing unrolled list SIMD scans (values: %d) ---> ", count);
+    UnrolledList list;
+    ulist_init(&list, sizeof(UnrolledNode) * (count / 2 + 4));
+    uint16_t *values = malloc(sizeof(uint16_t) * count);
+
+    // A small value range gives duplicates in most nodes
+    for (int i = 0; i < count; i++)
+    {
+        values[i] = rand() % 64;
+        ulist_insert(&list, values[i]);
+    }
+    // Partially filled nodes, so the scans must ignore slots past count
+    for (int i = 0; i < count / 4; i++)
+        ulist_delete(&list, rand() % 64);
+
+    for (uint16_t value = 0; value < 70; value++)
+    {
+        ulist_use_simd(0);
+        UListPos scalar_pos = ulist_search(&list, value);
+        size_t scalar_count = ulist_count_value(&list, value);
+        ulist_use_simd(1);
+        UListPos simd_pos = ulist_search(&list, value);
+        size_t simd_count = ulist_count_value(&list, value);
+
+        my_assert(scalar_pos.node == simd_pos.node && scalar_pos.index == simd_pos.index);
+        my_assert(scalar_count == simd_count);
+        my_assert(simd_pos.node == NULL || simd_pos.node->values[simd_pos.index] == value);
+    }
+
+    free(values);
+    ulist_cleanup(&list);
+    printf_green("[PASS].\n");
+}
+
+// ********* Compressed list *********
+
+// Checks that the compressed list holds exactly the expected values in order
+int compressed_matches(CompressedList *list, const uint16_t *expected, size_t count)
+{
+    uint16_t *values = malloc(sizeof(uint16_t) * (count + 1));
+    size_t copied = clist_to_array(list, values, count + 1);
+    int matches = copied == count && memcmp(values, expected, count * sizeof(uint16_t)) == 0;
+    for (CompressedChunk *chunk = list->head; chunk != NULL; chunk = chunk->next)
+        if (chunk->count == 0 || chunk->used > CLIST_DELTA_BYTES)
+            matches = 0;
+    free(values);
+    return matches && clist_count_nodes(list) == count;
+}
+
+void test_compressed_list(int count)
+{
+    printf_yellow("  Testing compressed list (values: %d) ---> ", count);
+    CompressedList list;
+    clist_init(&list, sizeof(CompressedChunk) * (count / 8 + 16));
+    uint16_t *expected = malloc(sizeof(uint16_t) * (count + 2));
+
+    // A random walk with steps of every encoded length, and both wrap-arounds
+    uint16_t value = 100;
+    for (int i = 0; i < count; i++)
+    {
+        int step = i % 97 == 0 ? rand() % 65536 : i % 13 == 0 ? rand() % 16384 - 8192 : rand() % 33 - 16;
+        value = (uint16_t)(value + step);
+        clist_insert(&list, value);
+        expected[i] = value;
+    }
+    my_assert(compressed_matches(&list, expected, count));
+    my_assert(clist_memory(&list) < (size_t)count * 2);
+
+    // Insert after values in the middle of full chunks, forcing splits
+    size_t length = count;
+    for (int i = 0; i < count / 4; i++)
+    {
+        uint16_t target = expected[rand() % length];
+        size_t at = 0;
+        while (expected[at] != target) // The search finds the first occurrence
+            at++;
+        CListPos pos = clist_search(&list, target);
+        my_assert(pos.chunk != NULL && clist_value(pos) == target);
+        uint16_t data = (uint16_t)(expected[at] + rand() % 9 - 4);
+        clist_insert_after(&list, pos, data);
+        memmove(expected + at + 2, expected + at + 1, sizeof(uint16_t) * (length - at - 1));
+        expected[at + 1] = data;
+        length++;
+        expected = realloc(expected, sizeof(uint16_t) * (length + 2));
+    }
+    my_assert(compressed_matches(&list, expected, length));
+
+    // Delete everything in a random order
+    while (length > 0)
+    {
+        uint16_t data = expected[rand() % length];
+        size_t at = 0;
+        while (expected[at] != data)
+            at++;
+        clist_delete(&list, data);
+        memmove(expected + at, expected + at + 1, sizeof(uint16_t) * (length - at - 1));
+        length--;
+        if (length % 64 == 0)
+            my_assert(compressed_matches(&list, expected, length));
+    }
+    my_assert(list.head == NULL && list.tail == NULL && list.chunks == 0);
+    my_assert(clist_search(&list, 0).chunk == NULL);
+
+    free(expected);
+    clist_cleanup(&list);
+    printf_green("[PASS].\n");
+}
+
+// ********* Benchmarks *********
+
+// Runs a test and returns its wall-clock time in microseconds
+long time_list_test(void (*test_func)(TestParams *), TestParams *params)
+{
+    struct timeval start, end;
+    gettimeofday(&start, NULL);
+    test_func(params);
+    gettimeofday(&end, NULL);
+    return (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+}
+
+// Times the basic operations over the same thread and node sweep as the stress tests,
+// so builds with different locking strategies can be compared
+#define SWEEP_MIN_NODES_EXP 8
+#define SWEEP_MAX_NODES_EXP 14
+
+void benchmark_list_sweep(int max_nodes_exp)
+{
+    if (max_nodes_exp < SWEEP_MIN_NODES_EXP)
+    {
+        printf("The node sweep needs at least 2^%d nodes\n", SWEEP_MIN_NODES_EXP);
+        return;
+    }
+    if (max_nodes_exp > SWEEP_MAX_NODES_EXP)
+    {
+        printf("Limiting the node sweep to 2^%d nodes\n", SWEEP_MAX_NODES_EXP);
+        max_nodes_exp = SWEEP_MAX_NODES_EXP;
+    }
+    long results[9][SWEEP_MAX_NODES_EXP + 1][4];
+
+    for (int i = 0; i < 9; i++)                  // from 2^0 = 1 up to 2^8 = 256 threads
+        for (int j = SWEEP_MIN_NODES_EXP; j <= max_nodes_exp; j++) // from 2^8 = 256 nodes up
+        {
+            TestParams params = {.num_threads = pow(2, i), .num_nodes = pow(2, j)};
+            results[i][j][0] = time_list_test(test_list_insert_multithread, &params);
+            results[i][j][1] = time_list_test(test_list_insert_after_multithread, &params);
+            results[i][j][2] = time_list_test(test_list_insert_before_multithreaded, &params);
+            results[i][j][3] = time_list_test(test_list_delete_multithreaded, &params);
+        }
+
+    printf("\nTime in microseconds:\n");
+    printf("  threads    nodes       insert insert_after insert_before       delete\n");
+    for (int i = 0; i < 9; i++)
+        for (int j = SWEEP_MIN_NODES_EXP; j <= max_nodes_exp; j++)
+            printf("  %7d %8d %12ld %12ld %13ld %12ld\n", 1 << i, 1 << j,
+                   results[i][j][0], results[i][j][1], results[i][j][2], results[i][j][3]);
+}
+
+#ifdef LIST_HANDLE_API
+// Compares memory use and search time of the Node list and the unrolled list
+void benchmark_unrolled_search()
+{
+    printf("\nSearch time in microseconds for every value in the list:\n");
+    printf("    nodes   bytes/elem(list) bytes/elem(unrolled)         list     unrolled\n");
+    for (int j = 8; j < 15; j++) // from 2^8 = 256 up to 2^14 = 16384 nodes
+    {
+        int count = 1 << j;
+        struct timeval start, end;
+
+        List list;
+        list_create(&list, sizeof(Node) * count);
+        for (int i = 0; i < count; i++)
+            list_append(&list, i);
+        gettimeofday(&start, NULL);
+        for (int i = 0; i < count; i++)
+            my_assert(list_find(&list, i) != NULL);
+        gettimeofday(&end, NULL);
+        long list_time = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+        list_destroy(&list);
+
+        UnrolledList ulist;
+        ulist_init(&ulist, sizeof(UnrolledNode) * (count / ULIST_NODE_CAPACITY + 1));
+        for (int i = 0; i < count; i++)
+            ulist_insert(&ulist, i);
+        size_t unrolled_nodes = 0;
+        for (UnrolledNode *node = ulist.head; node != NULL; node = node->next)
+            unrolled_nodes++;
+        gettimeofday(&start, NULL);
+        for (int i = 0; i < count; i++)
+            my_assert(ulist_search(&ulist, i).node != NULL);
+        gettimeofday(&end, NULL);
+        long unrolled_time = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+        ulist_cleanup(&ulist);
+
+        printf("  %7d %18.2f %20.2f %12ld %12ld\n", count, (double)sizeof(Node),
+               (double)(unrolled_nodes * sizeof(UnrolledNode)) / count, list_time, unrolled_time);
+    }
+}
+#endif
+
+// Compares the scalar and SIMD node scans of the unrolled list
+void benchmark_unrolled_simd()
+{
+    printf("\nUnrolled list time in microseconds for every value in the list:\n");
+    printf("    nodes  search(scalar)    search(simd)   count(scalar)     count(simd)\n");
+    for (int j = 8; j < 15; j++) // from 2^8 = 256 up to 2^14 = 16384 nodes
+    {
+        int count = 1 << j;
+        long times[2][2];
+
+        UnrolledList ulist;
+        ulist_init(&ulist, sizeof(UnrolledNode) * (count / ULIST_NODE_CAPACITY + 1));
+        for (int i = 0; i < count; i++)
+            ulist_insert(&ulist, i);
+
+        for (int simd = 0; simd < 2; simd++)
+        {
+            struct timeval start, end;
+            size_t found = 0;
+            ulist_use_simd(simd);
+
+            gettimeofday(&start, NULL);
+            for (int i = 0; i < count; i++)
+                found += ulist_search(&ulist, i).node != NULL;
+            gettimeofday(&end, NULL);
+            times[0][simd] = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+
+            gettimeofday(&start, NULL);
+            for (int i = 0; i < count; i++)
+                found += ulist_count_value(&ulist, i);
+            gettimeofday(&end, NULL);
+            times[1][simd] = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+
+            my_assert(found == 2 * (size_t)count);
+        }
+        ulist_cleanup(&ulist);
+
+        printf("  %7d %15ld %15ld %15ld %15ld\n", count, times[0][0], times[0][1], times[1][0], times[1][1]);
+    }
+}
+
+#ifdef LIST_HANDLE_API
+// Times finding and then deleting every value from the back of the list, with and
+// without the value index
+void benchmark_list_index()
+{
+    printf("\nTime in microseconds for every value in the list, last value first:\n");
+    printf("    nodes  search(scan) search(index)  delete(scan) delete(index)\n");
+    for (int j = 8; j < 15; j++) // from 2^8 = 256 up to 2^14 = 16384 nodes
+    {
+        int count = 1 << j;
+        long times[2][2];
+
+        for (int indexed = 0; indexed < 2; indexed++)
+        {
+            struct timeval start, end;
+            List list;
+            list_create(&list, sizeof(Node) * count + LIST_INDEX_BYTES);
+            if (indexed)
+                list_index_enable(&list);
+            for (int i = 0; i < count; i++)
+                list_append(&list, i);
+
+            gettimeofday(&start, NULL);
+            for (int i = count - 1; i >= 0; i--)
+                my_assert(list_find(&list, i) != NULL);
+            gettimeofday(&end, NULL);
+            times[0][indexed] = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+
+            gettimeofday(&start, NULL);
+            for (int i = count - 1; i >= 0; i--)
+                list_remove(&list, i);
+            gettimeofday(&end, NULL);
+            times[1][indexed] = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+
+            my_assert(list_length(&list) == 0);
+            list_destroy(&list);
+        }
+
+        printf("  %7d %13ld %13ld %13ld %13ld\n", count, times[0][0], times[0][1], times[1][0], times[1][1]);
+    }
+}
+#endif
+
+#ifdef LIST_HANDLE_API
+// Compares appending values one at a time against one bulk insert
+void benchmark_list_bulk()
+{
+    printf("\nAppend time in microseconds for the whole array:\n");
+    printf("    nodes  list_append list_insert_many\n");
+    for (int j = 8; j < 19; j++) // from 2^8 = 256 up to 2^18 = 262144 nodes
+    {
+        int count = 1 << j;
+        long times[2];
+        uint16_t *values = malloc(sizeof(uint16_t) * count);
+        for (int i = 0; i < count; i++)
+            values[i] = i;
+
+        for (int bulk = 0; bulk < 2; bulk++)
+        {
+            struct timeval start, end;
+            List list;
+            list_create(&list, sizeof(Node) * count);
+
+            gettimeofday(&start, NULL);
+            if (bulk)
+                list_insert_many(&list, values, count);
+            else
+                for (int i = 0; i < count; i++)
+                    list_append(&list, values[i]);
+            gettimeofday(&end, NULL);
+            times[bulk] = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+
+            my_assert(list_length(&list) == (size_t)count);
+            list_destroy(&list);
+        }
+        free(values);
+
+        printf("  %7d %12ld %16ld\n", count, times[0], times[1]);
+    }
+}
+#endif
+
+#ifdef LIST_HANDLE_API
+void *thread_find_function(void *arg)
+{
+    ReaderParams *params = (ReaderParams *)arg;
+    for (int i = 0; i < params->iterations; i++)
+        if (list_find(params->list, rand() % params->num_values) == NULL)
+            params->failures++;
+    return NULL;
+}
+
+// Measures list_find throughput as readers are added, with one writer running alongside
+void benchmark_list_readers()
+{
+    const int num_values = 1024, iterations = 2000;
+    printf("\nlist_find calls per millisecond over %d values, one writer running:\n", num_values);
+    printf("  readers  finds/ms\n");
+    for (int readers = 1; readers <= 16; readers *= 2)
+    {
+        List list;
+        list_create(&list, sizeof(Node) * num_values * 2);
+        for (int i = 0; i < num_values; i++)
+            list_append(&list, i);
+
+        int stop = 0;
+        pthread_t threads[readers];
+        ReaderParams params[readers];
+        struct timeval start, end;
+        gettimeofday(&start, NULL);
+        for (int i = 0; i < readers; i++)
+        {
+            params[i] = (ReaderParams){.list = &list, .num_values = num_values, .iterations = iterations, .stop = &stop};
+            pthread_create(&threads[i], NULL, thread_find_function, &params[i]);
+        }
+        for (int i = 0; i < readers; i++)
+        {
+            uint16_t value = rand() % num_values;
+            list_remove(&list, value);
+            list_append(&list, value);
+        }
+        for (int i = 0; i < readers; i++)
+            pthread_join(threads[i], NULL);
+        gettimeofday(&end, NULL);
+        long elapsed = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+
+        list_destroy(&list);
+        printf("  %7d %9.0f\n", readers, (double)readers * iterations * 1000.0 / (elapsed ? elapsed : 1));
+    }
+}
+#endif
+
+#ifdef LIST_HANDLE_API
+// Times seeking every value of a sorted list by scanning and through the skip list,
+// and building the sorted list from random values in sorted mode
+void benchmark_list_sorted()
+{
+    printf("\nTime in microseconds for every value in the list:\n");
+    printf("    nodes   seek(scan)   seek(skip) sorted insert\n");
+    for (int j = 8; j < 17; j++) // from 2^8 = 256 up to 2^16 = 65536 nodes
+    {
+        int count = 1 << j;
+        struct timeval start, end;
+        long times[3];
+
+        List list;
+        list_create(&list, sizeof(Node) * count * 2);
+        list_sorted_enable(&list);
+        gettimeofday(&start, NULL);
+        for (int i = 0; i < count; i++)
+            list_append(&list, rand() % 65536);
+        gettimeofday(&end, NULL);
+        times[2] = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+
+        for (int sorted = 0; sorted < 2; sorted++)
+        {
+            if (!sorted)
+                list_sorted_disable(&list);
+            else
+                list_sorted_enable(&list);
+            gettimeofday(&start, NULL);
+            for (int i = 0; i < count; i++)
+                my_assert(list_seek(&list, 0) == list.head);
+            for (int i = 0; i < count; i++)
+                list_seek(&list, i * (65536 / count));
+            gettimeofday(&end, NULL);
+            times[sorted] = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+        }
+        list_sorted_disable(&list);
+        list_destroy(&list);
+
+        printf("  %7d %12ld %12ld %13ld\n", count, times[0], times[1], times[2]);
+    }
+}
+#endif
+
+#ifdef LIST_HANDLE_API
+// Times reading pages of 32 values at random positions by walking from the head and
+// by seeking through the position checkpoints
+void benchmark_list_positions()
+{
+    const int pages = 1024;
+    printf("\nTime in microseconds for %d pages of 32 values:\n", pages);
+    printf("    nodes   walk+print   seek+print\n");
+    for (int j = 10; j < 17; j++) // from 2^10 = 1024 up to 2^16 = 65536 nodes
+    {
+        int count = 1 << j;
+        struct timeval start, end;
+        long times[2];
+
+        List list;
+        list_create(&list, sizeof(Node) * count);
+        for (int i = 0; i < count; i++)
+            list_append(&list, rand() % 65536);
+
+        FILE *original = stdout;
+        stdout = fopen("/dev/null", "w");
+        for (int seek = 0; seek < 2; seek++)
+        {
+            srand(j);
+            gettimeofday(&start, NULL);
+            for (int page = 0; page < pages; page++)
+            {
+                size_t first = rand() % (count - 32);
+                if (seek)
+                {
+                    list_print_slice(&list, first, first + 31);
+                    continue;
+                }
+                Node *from = list.head;
+                for (size_t i = 0; i < first; i++)
+                    from = from->next;
+                Node *to = from;
+                for (int i = 0; i < 31; i++)
+                    to = to->next;
+                list_print_range(&list, from, to);
+            }
+            gettimeofday(&end, NULL);
+            times[seek] = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+        }
+        fclose(stdout);
+        stdout = original;
+        list_destroy(&list);
+
+        printf("  %7d %12ld %12ld\n", count, times[0], times[1]);
+    }
+}
+#endif
+
+#ifdef LIST_HANDLE_API
+void *thread_churn_function(void *arg)
+{
+    List *list = (List *)arg;
+    for (int i = 0; i < 65536; i++)
+    {
+        list_append(list, i);
+        list_remove(list, i);
+    }
+    return NULL;
+}
+
+// Times append/remove pairs from a growing number of threads, all on one list and
+// with one list per thread on a shared pool
+void benchmark_list_instances()
+{
+    printf("\nAppend/remove pairs per millisecond:\n");
+    printf("  threads  one list  list per thread\n");
+    for (int threads = 1; threads <= 16; threads *= 2)
+    {
+        double rates[2];
+        for (int separate = 0; separate < 2; separate++)
+        {
+            mem_init(sizeof(Node) * 1024 * threads);
+            List lists[threads];
+            for (int i = 0; i < threads; i++)
+                list_create_shared(&lists[i]);
+
+            pthread_t ids[threads];
+            struct timeval start, end;
+            gettimeofday(&start, NULL);
+            for (int i = 0; i < threads; i++)
+                pthread_create(&ids[i], NULL, thread_churn_function, &lists[separate ? i : 0]);
+            for (int i = 0; i < threads; i++)
+                pthread_join(ids[i], NULL);
+            gettimeofday(&end, NULL);
+            long elapsed = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+            rates[separate] = threads * 65536 * 1000.0 / (elapsed ? elapsed : 1);
+
+            for (int i = 0; i < threads; i++)
+                list_destroy(&lists[i]);
+            mem_deinit();
+        }
+        printf("  %7d %9.0f %16.0f\n", threads, rates[0], rates[1]);
+    }
+}
+#endif
+
+#ifdef LIST_HANDLE_API
+typedef struct
+{
+    List *list;         // Used when sharded is NULL
+    ShardedList *sharded;
+    int num_values;
+} InsertParams;
+
+void *thread_spread_insert_function(void *arg)
+{
+    InsertParams *params = (InsertParams *)arg;
+    for (int i = 0; i < params->num_values; i++)
+    {
+        uint16_t value = (uint16_t)(i * 40503u); // rand() takes a global lock
+        if (params->sharded)
+            shlist_insert(params->sharded, value);
+        else
+            list_append(params->list, value);
+    }
+    return NULL;
+}
+
+// Times inserting 65536 values split over 1 to 256 threads into one List and
+// into a sharded list with 64 shards
+void benchmark_sharded_list()
+{
+    const int total = 65536;
+    printf("\nTime in microseconds to insert %d values:\n", total);
+    printf("  threads         list      sharded\n");
+    for (int i = 0; i < 9; i++) // from 2^0 = 1 up to 2^8 = 256 threads
+    {
+        int threads = 1 << i;
+        long times[2];
+        for (int sharded = 0; sharded < 2; sharded++)
+        {
+            List list;
+            ShardedList shards;
+            if (sharded)
+                shlist_init(&shards, 64, sizeof(Node) * total * 2);
+            else
+                list_create(&list, sizeof(Node) * total * 2);
+
+            pthread_t ids[threads];
+            InsertParams params = {.list = &list, .sharded = sharded ? &shards : NULL, .num_values = total / threads};
+            struct timeval start, end;
+            gettimeofday(&start, NULL);
+            for (int t = 0; t < threads; t++)
+                pthread_create(&ids[t], NULL, thread_spread_insert_function, &params);
+            for (int t = 0; t < threads; t++)
+                pthread_join(ids[t], NULL);
+            gettimeofday(&end, NULL);
+            times[sharded] = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+
+            if (sharded)
+                shlist_cleanup(&shards);
+            else
+                list_destroy(&list);
+        }
+        printf("  %7d %12ld %12ld\n", threads, times[0], times[1]);
+    }
+}
+#endif
+
+#ifdef LIST_HANDLE_API
+int compare_values(const void *a, const void *b)
+{
+    return (int)*(const uint16_t *)a - (int)*(const uint16_t *)b;
+}
+
+// Times sorting random lists by copying out, qsort and rebuilding, and with each
+// in-place sort
+void benchmark_list_sort()
+{
+    printf("\nTime in microseconds to sort the list:\n");
+    printf("    nodes  qsort+rebuild   merge sort  parallel(4)        radix\n");
+    for (int j = 10; j < 21; j += 2) // from 2^10 = 1024 up to 2^20 nodes
+    {
+        int count = 1 << j;
+        uint16_t *values = malloc(sizeof(uint16_t) * count);
+        long times[4];
+        for (int method = 0; method < 4; method++)
+        {
+            List list;
+            list_create(&list, sizeof(Node) * count * 2);
+            for (int i = 0; i < count; i++)
+                list_append(&list, rand() % 65536);
+
+            struct timeval start, end;
+            gettimeofday(&start, NULL);
+            if (method == 0)
+            {
+                list_to_array(&list, values, count);
+                qsort(values, count, sizeof(uint16_t), compare_values);
+                list_destroy(&list);
+                list_from_array(&list, sizeof(Node) * count * 2, values, count);
+            }
+            else if (method == 1)
+                list_sort(&list);
+            else if (method == 2)
+                list_sort_parallel(&list, 4);
+            else
+                list_sort_radix(&list);
+            gettimeofday(&end, NULL);
+            times[method] = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+
+            my_assert(list_is_sorted(&list));
+            list_destroy(&list);
+        }
+        free(values);
+        printf("  %7d %14ld %12ld %12ld %12ld\n", count, times[0], times[1], times[2], times[3]);
+    }
+}
+#endif
+
+#ifdef LIST_HANDLE_API
+// Times summing a list whose nodes are scattered in memory (random values, then
+// sorted) by following next pointers and with the prefetching iterator
+void benchmark_list_iterator()
+{
+    printf("\nTime in microseconds to sum the list:\n");
+    printf("    nodes         walk     iterator\n");
+    for (int j = 12; j < 23; j += 2) // from 2^12 = 4096 up to 2^22 nodes
+    {
+        int count = 1 << j;
+        List list;
+        list_create(&list, sizeof(Node) * count);
+        for (int i = 0; i < count; i++)
+            list_append(&list, rand() % 65536);
+        list_sort_radix(&list);
+
+        struct timeval start, end;
+        long times[2];
+        unsigned long sums[2] = {0, 0};
+        gettimeofday(&start, NULL);
+        for (Node *node = list.head; node != NULL; node = node->next)
+            sums[0] += node->data;
+        gettimeofday(&end, NULL);
+        times[0] = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+
+        ListIter iter;
+        gettimeofday(&start, NULL);
+        list_iter_begin(&list, &iter);
+        for (Node *node = list_iter_next(&iter); node != NULL; node = list_iter_next(&iter))
+            sums[1] += node->data;
+        list_iter_end(&iter);
+        gettimeofday(&end, NULL);
+        times[1] = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+
+        my_assert(sums[0] == sums[1]);
+        list_destroy(&list);
+        printf("  %7d %12ld %12ld\n", count, times[0], times[1]);
+    }
+}
+#endif
+
+#ifdef LIST_HANDLE_API
+// Times full scans (list_find of a missing value) of a list whose nodes are
+// scattered in memory, before and after list_compact
+void benchmark_list_compact()
+{
+    printf("\nTime in microseconds for 8 full scans:\n");
+    printf("    nodes  locality    scattered    compacted   compaction\n");
+    for (int j = 12; j < 23; j += 2) // from 2^12 = 4096 up to 2^22 nodes
+    {
+        int count = 1 << j;
+        List list;
+        list_create(&list, sizeof(Node) * count * 2);
+        for (int i = 0; i < count; i++)
+            list_append(&list, 1 + rand() % 65535);
+        list_sort_radix(&list); // List order now jumps around memory
+        double locality = list_locality(&list);
+
+        struct timeval start, end;
+        long times[3];
+        for (int compacted = 0; compacted < 2; compacted++)
+        {
+            gettimeofday(&start, NULL);
+            for (int i = 0; i < 8; i++)
+                my_assert(list_find(&list, 0) == NULL);
+            gettimeofday(&end, NULL);
+            times[compacted] = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+
+            if (!compacted)
+            {
+                gettimeofday(&start, NULL);
+                my_assert(list_compact(&list) == 0);
+                gettimeofday(&end, NULL);
+                times[2] = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+            }
+        }
+        list_destroy(&list);
+        printf("  %7d %9.2f %12ld %12ld %12ld\n", count, locality, times[0], times[1], times[2]);
+    }
+}
+#endif
+
+#ifdef LIST_HANDLE_API
+// Times rebuilding a list value by value against saving it and loading or mapping
+// the snapshot
+void benchmark_list_snapshot()
+{
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/benchmark_linked_list_%d.snapshot", (int)getpid());
+    printf("\nTime in microseconds:\n");
+    printf("    nodes      appends         save         load    view open\n");
+    for (int j = 16; j < 23; j += 2) // from 2^16 = 65536 up to 2^22 nodes
+    {
+        int count = 1 << j;
+        struct timeval start, end;
+        long times[4];
+
+        List list;
+        list_create(&list, sizeof(Node) * count);
+        gettimeofday(&start, NULL);
+        for (int i = 0; i < count; i++)
+            list_append(&list, rand() % 65536);
+        gettimeofday(&end, NULL);
+        times[0] = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+
+        gettimeofday(&start, NULL);
+        my_assert(list_save(&list, path) == 0);
+        gettimeofday(&end, NULL);
+        times[1] = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+        list_destroy(&list);
+
+        list_create(&list, sizeof(Node) * count);
+        gettimeofday(&start, NULL);
+        my_assert(list_load(&list, path) == 0);
+        gettimeofday(&end, NULL);
+        times[2] = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+        list_destroy(&list);
+
+        ListView view;
+        gettimeofday(&start, NULL);
+        my_assert(list_view_open(&view, path) == 0);
+        gettimeofday(&end, NULL);
+        times[3] = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+        list_view_close(&view);
+
+        printf("  %7d %12ld %12ld %12ld %12ld\n", count, times[0], times[1], times[2], times[3]);
+    }
+    remove(path);
+}
+#endif
+
+// Compares memory per value and search time of the unrolled and compressed lists
+// on a random walk with small steps
+void benchmark_compressed_list()
+{
+    const int searches = 256;
+    printf("\nMemory per value and time in microseconds for %d searches:\n", searches);
+    printf("    values  bytes/elem(unrolled) bytes/elem(compressed)     unrolled   compressed\n");
+    for (int j = 12; j < 21; j += 2) // from 2^12 = 4096 up to 2^20 values
+    {
+        int count = 1 << j;
+        uint16_t *values = malloc(sizeof(uint16_t) * count);
+        uint16_t value = rand();
+        for (int i = 0; i < count; i++)
+            values[i] = value = (uint16_t)(value + rand() % 33 - 16);
+
+        UnrolledList ulist;
+        ulist_init(&ulist, sizeof(UnrolledNode) * (count / ULIST_NODE_CAPACITY + 1));
+        for (int i = 0; i < count; i++)
+            ulist_insert(&ulist, values[i]);
+        size_t unrolled_nodes = 0;
+        for (UnrolledNode *node = ulist.head; node != NULL; node = node->next)
+            unrolled_nodes++;
+        struct timeval start, end;
+        srand(j);
+        gettimeofday(&start, NULL);
+        for (int i = 0; i < searches; i++)
+            my_assert(ulist_search(&ulist, values[rand() % count]).node != NULL);
+        gettimeofday(&end, NULL);
+        long unrolled_time = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+        ulist_cleanup(&ulist);
+
+        CompressedList clist;
+        clist_init(&clist, sizeof(CompressedChunk) * (count / 64 + 1));
+        for (int i = 0; i < count; i++)
+            clist_insert(&clist, values[i]);
+        size_t compressed_bytes = clist_memory(&clist);
+        srand(j);
+        gettimeofday(&start, NULL);
+        for (int i = 0; i < searches; i++)
+            my_assert(clist_search(&clist, values[rand() % count]).chunk != NULL);
+        gettimeofday(&end, NULL);
+        long compressed_time = (end.tv_sec - start.tv_sec) * 1000000L + (end.tv_usec - start.tv_usec);
+        clist_cleanup(&clist);
+
+        free(values);
+        printf("  %8d %21.2f %22.2f %12ld %12ld\n", count, (double)(unrolled_nodes * sizeof(UnrolledNode)) / count,
+               (double)compressed_bytes / count, unrolled_time, compressed_time);
+    }
+}
+
 // Main function to run all tests
 int main(int argc, char *argv[])
 {
@@ -670,6 +2570,21 @@ int main(int argc, char *argv[])
         printf(" 6. test_list_insert_after - Test multiple insertions after a given node\n");
         printf(" 7. test_list_insert_after - Test multiple insertions after a given node\n");
         printf(" 8. test_list_delete - Test multiple detelions\n");
+        printf(" 9. benchmark - Time the basic operations across the thread and node sweep\n");
+        printf("10. benchmark_unrolled - Compare memory and search time of the Node and unrolled lists\n");
+        printf("11. benchmark_unrolled_simd - Compare scalar and SIMD search and count in the unrolled list\n");
+        printf("12. benchmark_index - Compare delete by value with and without the value index\n");
+        printf("13. benchmark_bulk - Compare single appends with one bulk insert\n");
+        printf("14. benchmark_readers - Measure lock-free list_find throughput as readers are added\n");
+        printf("15. benchmark_sorted - Compare seeking in a sorted list by scan and by skip list\n");
+        printf("16. benchmark_positions - Compare paging through a list by walking and by positional seek\n");
+        printf("17. benchmark_instances - Compare writers sharing one list with one list per writer\n");
+        printf("18. benchmark_sharded - Compare insert time of one list and a sharded list across threads\n");
+        printf("19. benchmark_sort - Compare rebuilding a sorted list with the in-place sorts\n");
+        printf("20. benchmark_iterator - Compare walking a scattered list with the prefetching iterator\n");
+        printf("21. benchmark_compact - Compare scans of a scattered list before and after compaction\n");
+        printf("22. benchmark_compressed - Compare memory and search time of the unrolled and compressed lists\n");
+        printf("23. benchmark_snapshot - Compare rebuilding a list by appends with loading a snapshot\n");
         printf(" 0. Run all tests\n");
         return 1;
     }
@@ -686,6 +2601,34 @@ int main(int argc, char *argv[])
         test_list_insert_before_multithreaded(&(TestParams){.num_threads = base_num_threads, .num_nodes = 1024});
         test_list_delete_multithreaded(&(TestParams){.num_threads = base_num_threads, .num_nodes = 1024});
 
+#ifdef LIST_HANDLE_API
+        printf("\nTesting the List handle:\n");
+        test_list_handle_tail(16384);
+        test_list_node_freelist(1000);
+        test_list_index(4096);
+        test_list_doubly_linked(4096);
+        test_list_bulk(4096);
+        test_list_format(4096);
+        test_list_positions(4096);
+        test_list_iterator(4096);
+        test_list_snapshot(4096);
+        test_list_sort(16384);
+        test_list_compact(4096);
+        test_list_sorted(4096);
+        test_list_concurrent_readers(8, 1024);
+        test_list_index_readers(4, 1024);
+        test_list_slice_writers(4, 1024);
+        test_list_instances(256, 8, 256);
+        test_sharded_list(8, 4096);
+#endif
+
+        printf("\nTesting the unrolled list:\n");
+        test_unrolled_list(1024);
+        test_unrolled_simd(4096);
+
+        printf("\nTesting the compressed list:\n");
+        test_compressed_list(16384);
+
         printf("\nStress testing basic operations with various numbers of threads and nodes:\n");
         for (int i = 0; i < 9; i++)      // from 2^0 = 1 up to 2^8 = 256 threads
             for (int j = 8; j < 15; j++) // from 2^8 = 256 up to 2^14 = 16384 nodes
@@ -730,6 +2673,76 @@ int main(int argc, char *argv[])
                 test_list_delete_multithreaded(&(TestParams){.num_threads = pow(2, i), .num_nodes = pow(2, j)});
         break;
 
+    case 9:
+        benchmark_list_sweep(argc > 2 ? atoi(argv[2]) : SWEEP_MAX_NODES_EXP);
+        break;
+    case 10:
+#ifdef LIST_HANDLE_API
+        benchmark_unrolled_search();
+#endif
+        break;
+    case 11:
+        benchmark_unrolled_simd();
+        break;
+    case 12:
+#ifdef LIST_HANDLE_API
+        benchmark_list_index();
+#endif
+        break;
+    case 13:
+#ifdef LIST_HANDLE_API
+        benchmark_list_bulk();
+#endif
+        break;
+    case 14:
+#ifdef LIST_HANDLE_API
+        benchmark_list_readers();
+#endif
+        break;
+    case 15:
+#ifdef LIST_HANDLE_API
+        benchmark_list_sorted();
+#endif
+        break;
+    case 16:
+#ifdef LIST_HANDLE_API
+        benchmark_list_positions();
+#endif
+        break;
+    case 17:
+#ifdef LIST_HANDLE_API
+        benchmark_list_instances();
+#endif
+        break;
+    case 18:
+#ifdef LIST_HANDLE_API
+        benchmark_sharded_list();
+#endif
+        break;
+    case 19:
+#ifdef LIST_HANDLE_API
+        benchmark_list_sort();
+#endif
+        break;
+    case 20:
+#ifdef LIST_HANDLE_API
+        benchmark_list_iterator();
+#endif
+        break;
+    case 21:
+#ifdef LIST_HANDLE_API
+        benchmark_list_compact();
+#endif
+        break;
+    case 22:
+        benchmark_compressed_list();
+        break;
+    case 23:
+#ifdef LIST_HANDLE_API
+        benchmark_list_snapshot();
+#endif
+        break;
+
     default:
         printf("Invalid test function\n");
         break;
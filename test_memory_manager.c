@@ -14,6 +14,7 @@
 #include "common_defs.h"
 
 #include <unistd.h>
+#include <sys/wait.h>
 
 #define debug 0
 
@@ -852,6 +853,311 @@ void run_concurrency_test(TestParams params)
     printf_green("[PASS].\n");
 }
 
+/*
+ * Frees a block into the quarantine, writes to it afterwards and checks that the
+ * write is detected. Quarantined memory must still be handed back when the pool runs dry.
+ */
+void test_quarantine_use_after_free()
+{
+    printf_yellow("  Testing \"quarantine use-after-free detection\" ---> ");
+
+    mem_init(1024);
+    mem_set_quarantine(512);
+
+    char *block = mem_alloc(64);
+    my_assert(block != NULL);
+    memset(block, 0x11, 64);
+    mem_free(block);
+    my_assert(mem_quarantine_check() == 0);
+
+    block[10] = 0x22; // Use after free
+    my_assert(mem_quarantine_check() == 1);
+
+    // The quarantined block must be evicted to satisfy an allocation of the whole pool
+    void *whole = mem_alloc(1024);
+    my_assert(whole != NULL);
+    my_assert(mem_quarantine_check() == 0);
+    mem_free(whole);
+
+    mem_set_quarantine(0);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+void *alloc_profile_block(void *arg)
+{
+    return mem_alloc((size_t)arg);
+}
+
+/*
+ * Samples every allocation (interval of 1 byte) and checks that the profiler
+ * attributes exactly the live bytes, dropping samples when blocks are freed.
+ * A new thread's first allocation is only sampled with the usual probability.
+ */
+void test_heap_profile_sampling()
+{
+    printf_yellow("  Testing \"heap profile sampling\" ---> ");
+
+    mem_init(4096);
+    mem_profile_start((size_t)1 << 40);
+    pthread_t thread;
+    void *first = NULL;
+    pthread_create(&thread, NULL, alloc_profile_block, (void *)64);
+    pthread_join(thread, &first);
+    my_assert(first != NULL && mem_profile_live_bytes() == 0);
+    mem_free(first);
+    mem_profile_stop();
+
+    mem_profile_start(1);
+
+    void *block1 = mem_alloc(100);
+    void *block2 = mem_alloc(200);
+    my_assert(block1 != NULL && block2 != NULL);
+    my_assert(mem_profile_live_bytes() == 300);
+
+    mem_free(block1);
+    my_assert(mem_profile_live_bytes() == 200);
+
+    char report[4096] = {0};
+    FILE *fp = tmpfile();
+    mem_profile_report(fp);
+    rewind(fp);
+    fread(report, 1, sizeof(report) - 1, fp);
+    fclose(fp);
+    my_assert(strstr(report, "1 sampled allocations") != NULL);
+    my_assert(strstr(report, "~200 bytes") != NULL);
+
+    mem_free(block2);
+    my_assert(mem_profile_live_bytes() == 0);
+
+    mem_profile_stop();
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+// Counts error events by code; allocating inside the callback proves it runs outside the pool lock
+void count_error_events(const MemEvent *event, void *user_data)
+{
+    int *counts = (int *)user_data;
+    counts[event->code]++;
+
+    void *probe = mem_alloc(1);
+    mem_free(probe);
+}
+
+void test_error_callback()
+{
+    printf_yellow("  Testing \"error callback\" ---> ");
+
+    int counts[MEM_ERR_METADATA + 1] = {0};
+    mem_init(1024);
+    mem_set_error_callback(count_error_events, counts);
+
+    mem_free(NULL); // Silent
+    int local = 0;
+    mem_free(&local);
+    my_assert(counts[MEM_ERR_INVALID_FREE] == 1);
+
+    void *block = mem_alloc(64);
+    mem_free(block);
+    mem_free(block);
+    my_assert(counts[MEM_ERR_DOUBLE_FREE] == 1);
+
+    my_assert(mem_resize(&local, 128) == NULL);
+    my_assert(counts[MEM_ERR_INVALID_RESIZE] == 1);
+
+    mem_set_error_callback(mem_error_callback_noop, NULL);
+    mem_free(&local);
+    my_assert(counts[MEM_ERR_INVALID_FREE] == 1);
+
+    mem_set_error_callback(NULL, NULL);
+    mem_deinit();
+    printf_green("[PASS].\n");
+}
+
+/*
+ * Builds a small pointer-linked chain in a file-backed pool, closes the pool and
+ * reopens it: the chain must be reachable from the root and the allocator must still
+ * know which blocks are in use. A file that is not a pool must be rejected.
+ */
+typedef struct PersistentNode
+{
+    struct PersistentNode *next;
+    int value;
+} PersistentNode;
+
+void test_file_backed_pool()
+{
+    printf_yellow("  Testing \"file-backed pool\" ---> ");
+
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/mem_pool_test_%d", (int)getpid());
+    unlink(path);
+
+    my_assert(mem_init_file(path, 4096) == 0);
+    PersistentNode *head = NULL;
+    for (int i = 0; i < 8; i++)
+    {
+        PersistentNode *node = mem_alloc(sizeof(PersistentNode));
+        my_assert(node != NULL);
+        node->value = i;
+        node->next = head;
+        head = node;
+    }
+    void *scratch = mem_alloc(100);
+    my_assert(scratch != NULL);
+    mem_free(scratch);
+    mem_set_root(head);
+    mem_deinit();
+
+    my_assert(mem_init_file(path, 0) == 1);
+    head = mem_get_root();
+    my_assert(head != NULL);
+    int expected = 7;
+    for (PersistentNode *node = head; node != NULL; node = node->next)
+        my_assert(node->value == expected--);
+    my_assert(expected == -1);
+
+    // The freed scratch block is reused; the nodes must not be handed out again
+    void *reused = mem_alloc(100);
+    my_assert(reused == scratch);
+    my_assert(mem_alloc(4096) == NULL);
+    for (PersistentNode *node = head; node != NULL;)
+    {
+        PersistentNode *next = node->next;
+        mem_free(node);
+        node = next;
+    }
+    mem_free(reused);
+    mem_set_root(NULL);
+    my_assert(mem_get_root() == NULL);
+
+    mem_deinit();
+
+    // Free blocks only merge forward at run time; reopening merges the rest
+    my_assert(mem_init_file(path, 0) == 1);
+    void *whole = mem_alloc(4096 - 16);
+    my_assert(whole != NULL);
+    mem_free(whole);
+    mem_deinit();
+
+    // A heap pool set up over an open file pool replaces it and has no tags
+    my_assert(mem_init_file(path, 0) == 1);
+    mem_init(1024);
+    char *first = mem_alloc(100);
+    char *second = mem_alloc(100);
+    my_assert(first != NULL && second == first + 100);
+    my_assert(mem_get_root() == NULL);
+    mem_deinit();
+    my_assert(mem_init_file(path, 0) == 1);
+    mem_deinit();
+
+    FILE *fp = fopen(path, "w");
+    fputs("not a pool", fp);
+    fclose(fp);
+    my_assert(mem_init_file(path, 4096) == -1);
+
+    unlink(path);
+    printf_green("[PASS].\n");
+}
+
+/*
+ * Worker processes attach to a shared pool, churn through allocations concurrently
+ * and each hand a filled buffer to the parent as an offset through a pipe. The parent
+ * reads the buffers in place, frees them, and after everyone detached the pool must
+ * merge back into a single free block.
+ */
+#define SHARED_POOL_WORKERS 4
+#define SHARED_POOL_SIZE (64 * 1024)
+
+int shared_pool_worker(const char *name, int id, int out)
+{
+    mem_deinit(); // Drop the mapping inherited from the parent and attach like an unrelated process
+    if (mem_init_shared(name, 0) != 1)
+        return 1;
+
+    unsigned seed = id + 1;
+    for (int i = 0; i < 500; i++)
+    {
+        size_t size = 16 + rand_r(&seed) % 512;
+        char *block = mem_alloc(size);
+        if (block)
+        {
+            memset(block, id, size);
+            mem_free(block);
+        }
+    }
+
+    char *buffer = mem_alloc(1024);
+    if (!buffer)
+        return 1;
+    memset(buffer, 'A' + id, 1024);
+    size_t offset = mem_offset(buffer);
+    if (write(out, &offset, sizeof(offset)) != sizeof(offset))
+        return 1;
+
+    mem_deinit();
+    return 0;
+}
+
+void test_shared_pool()
+{
+    printf_yellow("  Testing \"shared pool across processes\" ---> ");
+
+    char name[64];
+    snprintf(name, sizeof(name), "/mem_pool_test_%d", (int)getpid());
+    shm_unlink(name);
+
+    my_assert(mem_init_shared(name, SHARED_POOL_SIZE) == 0);
+    int fds[2];
+    my_assert(pipe(fds) == 0);
+
+    pid_t workers[SHARED_POOL_WORKERS];
+    for (int i = 0; i < SHARED_POOL_WORKERS; i++)
+    {
+        workers[i] = fork();
+        if (workers[i] == 0)
+        {
+            close(fds[0]);
+            _exit(shared_pool_worker(name, i, fds[1]));
+        }
+    }
+    close(fds[1]);
+
+    int seen[SHARED_POOL_WORKERS] = {0};
+    size_t offset;
+    while (read(fds[0], &offset, sizeof(offset)) == sizeof(offset))
+    {
+        char *buffer = mem_at(offset);
+        int id = buffer[0] - 'A';
+        my_assert(id >= 0 && id < SHARED_POOL_WORKERS);
+        for (int i = 0; i < 1024; i++)
+            my_assert(buffer[i] == 'A' + id);
+        seen[id]++;
+        mem_free(buffer);
+    }
+    close(fds[0]);
+
+    for (int i = 0; i < SHARED_POOL_WORKERS; i++)
+    {
+        int status;
+        my_assert(waitpid(workers[i], &status, 0) == workers[i]);
+        my_assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        my_assert(seen[i] == 1);
+    }
+    mem_deinit();
+
+    // Reattaching reloads the tags, merging the free blocks the workers left behind
+    my_assert(mem_init_shared(name, 0) == 1);
+    void *whole = mem_alloc(SHARED_POOL_SIZE - 16);
+    my_assert(whole != NULL);
+    mem_free(whole);
+    mem_deinit();
+
+    shm_unlink(name);
+    printf_green("[PASS].\n");
+}
+
 /* repeated from A1, as there were solutions that has issues */
 
 void test_looking_for_out_of_bounds()
@@ -937,6 +1243,12 @@ int main(int argc, char *argv[])
         test_memory_fragmentation_multithread((TestParams){.num_threads = base_num_threads, .memory_size = 2048});
         test_random_blocks_multithread((TestParams){.num_threads = base_num_threads, .block_size = 1024});
 
+        test_quarantine_use_after_free();
+        test_heap_profile_sampling();
+        test_error_callback();
+        test_file_backed_pool();
+        test_shared_pool();
+
         break;
 
     case 1:
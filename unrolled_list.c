@@ -0,0 +1,346 @@
+#include <stdio.h>
+#include <string.h>
+#include "unrolled_list.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ULIST_HAVE_X86_SIMD
+#endif
+
+// ********* Per-node value scans *********
+// Every variant returns a bitmask with bit i set when values[i] == data, for the
+// first node->count values. Vector loads never go past the values array; the
+// slots after the last full vector are compared one by one.
+
+typedef uint32_t (*match_mask_fn)(const UnrolledNode* node, uint16_t data);
+
+static uint32_t match_mask_scalar(const UnrolledNode* node, uint16_t data) {
+    uint32_t mask = 0;
+    for (int i = 0; i < node->count; i++) {
+        if (node->values[i] == data) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+#ifdef ULIST_HAVE_X86_SIMD
+static uint32_t scalar_tail(const UnrolledNode* node, uint16_t data, int from) {
+    uint32_t mask = 0;
+    for (int i = from; i < ULIST_NODE_CAPACITY; i++) {
+        if (node->values[i] == data) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+static uint32_t match_mask_sse2(const UnrolledNode* node, uint16_t data) {
+    const __m128i needle = _mm_set1_epi16((short)data);
+    uint32_t mask = 0;
+    int i = 0;
+    for (; i + 8 <= ULIST_NODE_CAPACITY; i += 8) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)(node->values + i));
+        // Narrow the 16-bit lane results to bytes so movemask yields one bit per lane
+        __m128i lanes = _mm_packs_epi16(_mm_cmpeq_epi16(chunk, needle), _mm_setzero_si128());
+        mask |= (uint32_t)_mm_movemask_epi8(lanes) << i;
+    }
+    mask |= scalar_tail(node, data, i);
+    return node->count < 32 ? mask & ((1u << node->count) - 1) : mask;
+}
+
+__attribute__((target("avx2")))
+static uint32_t match_mask_avx2(const UnrolledNode* node, uint16_t data) {
+    const __m256i needle = _mm256_set1_epi16((short)data);
+    __m256i low = _mm256_loadu_si256((const __m256i*)node->values);
+    __m128i high = _mm_loadu_si128((const __m128i*)(node->values + 16));
+
+    // Packing works per 128-bit half, so lanes 0-7 land in bits 0-7 and lanes 8-15 in bits 16-23
+    __m256i packed = _mm256_packs_epi16(_mm256_cmpeq_epi16(low, needle), _mm256_setzero_si256());
+    uint32_t bits = (uint32_t)_mm256_movemask_epi8(packed);
+    uint32_t mask = (bits & 0xFFu) | ((bits >> 8) & 0xFF00u);
+
+    __m128i high_lanes = _mm_packs_epi16(_mm_cmpeq_epi16(high, _mm256_castsi256_si128(needle)), _mm_setzero_si128());
+    mask |= (uint32_t)_mm_movemask_epi8(high_lanes) << 16;
+    mask |= scalar_tail(node, data, 24);
+    return node->count < 32 ? mask & ((1u << node->count) - 1) : mask;
+}
+#endif
+
+static match_mask_fn match_mask = NULL;
+
+// Picks the widest scan the CPU supports
+static match_mask_fn select_match_mask(void) {
+#ifdef ULIST_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return match_mask_avx2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return match_mask_sse2;
+    }
+#endif
+    return match_mask_scalar;
+}
+
+static inline uint32_t node_match_mask(const UnrolledNode* node, uint16_t data) {
+    match_mask_fn fn = __atomic_load_n(&match_mask, __ATOMIC_RELAXED);
+    if (fn == NULL) {
+        fn = select_match_mask();
+        __atomic_store_n(&match_mask, fn, __ATOMIC_RELAXED);
+    }
+    return fn(node, data);
+}
+
+void ulist_use_simd(int enabled) {
+    __atomic_store_n(&match_mask, enabled ? select_match_mask() : match_mask_scalar, __ATOMIC_RELAXED);
+}
+
+static UnrolledNode* new_unrolled_node(void) {
+    UnrolledNode* node = (UnrolledNode*)mem_alloc(sizeof(UnrolledNode));
+    if (!node) {
+        printf("Memory allocation failed\n");
+        return NULL;
+    }
+    node->next = NULL;
+    node->count = 0;
+    return node;
+}
+
+// Moves the upper half of a full node into a new node linked right after it.
+// Caller must hold the list lock.
+static UnrolledNode* split_node(UnrolledList* list, UnrolledNode* node) {
+    UnrolledNode* upper = new_unrolled_node();
+    if (!upper) {
+        return NULL;
+    }
+
+    uint16_t keep = node->count / 2;
+    upper->count = node->count - keep;
+    memcpy(upper->values, node->values + keep, upper->count * sizeof(uint16_t));
+    node->count = keep;
+
+    upper->next = node->next;
+    node->next = upper;
+    if (list->tail == node) {
+        list->tail = upper;
+    }
+    return upper;
+}
+
+// Initializes the unrolled list and memory manager
+void ulist_init(UnrolledList* list, size_t size) {
+    list->head = NULL;
+    list->tail = NULL;
+    list->count = 0;
+    pthread_mutex_init(&list->lock, NULL);
+    mem_init(size);
+}
+
+// Inserts a value at the end of the list
+void ulist_insert(UnrolledList* list, uint16_t data) {
+    pthread_mutex_lock(&list->lock);
+
+    UnrolledNode* tail = list->tail;
+    if (tail == NULL || tail->count == ULIST_NODE_CAPACITY) {
+        UnrolledNode* node = new_unrolled_node();
+        if (!node) {
+            pthread_mutex_unlock(&list->lock);
+            return;
+        }
+        if (tail == NULL) {
+            list->head = node;
+        } else {
+            tail->next = node;
+        }
+        list->tail = node;
+        tail = node;
+    }
+
+    tail->values[tail->count++] = data;
+    list->count++;
+
+    pthread_mutex_unlock(&list->lock);
+}
+
+// Inserts a value right after the given position, splitting the node if it is full
+void ulist_insert_after(UnrolledList* list, UListPos pos, uint16_t data) {
+    if (!pos.node) {
+        printf("Previous node cannot be NULL\n");
+        return;
+    }
+
+    pthread_mutex_lock(&list->lock);
+
+    UnrolledNode* node = pos.node;
+    uint16_t index = pos.index + 1;
+    if (node->count == ULIST_NODE_CAPACITY) {
+        UnrolledNode* upper = split_node(list, node);
+        if (!upper) {
+            pthread_mutex_unlock(&list->lock);
+            return;
+        }
+        if (index > node->count) {
+            index -= node->count;
+            node = upper;
+        }
+    }
+
+    memmove(node->values + index + 1, node->values + index, (node->count - index) * sizeof(uint16_t));
+    node->values[index] = data;
+    node->count++;
+    list->count++;
+
+    pthread_mutex_unlock(&list->lock);
+}
+
+// Deletes the first occurrence of the value. Empty nodes are freed and a node that
+// drops below half full absorbs its successor when both fit in one node.
+void ulist_delete(UnrolledList* list, uint16_t data) {
+    pthread_mutex_lock(&list->lock);
+
+    if (list->head == NULL) {
+        printf("List is empty\n");
+        pthread_mutex_unlock(&list->lock);
+        return;
+    }
+
+    UnrolledNode* previous = NULL;
+    UnrolledNode* node = list->head;
+    int index = -1;
+    while (node != NULL) {
+        uint32_t mask = node_match_mask(node, data);
+        if (mask) {
+            index = __builtin_ctz(mask);
+            break;
+        }
+        previous = node;
+        node = node->next;
+    }
+
+    if (node == NULL) {
+        printf("Data not found in the list\n");
+        pthread_mutex_unlock(&list->lock);
+        return;
+    }
+
+    memmove(node->values + index, node->values + index + 1, (node->count - index - 1) * sizeof(uint16_t));
+    node->count--;
+    list->count--;
+
+    if (node->count == 0) {
+        if (previous == NULL) {
+            list->head = node->next;
+        } else {
+            previous->next = node->next;
+        }
+        if (list->tail == node) {
+            list->tail = previous;
+        }
+        mem_free(node);
+    } else if (node->count < ULIST_NODE_CAPACITY / 2 && node->next != NULL &&
+               node->count + node->next->count <= ULIST_NODE_CAPACITY) {
+        UnrolledNode* next = node->next;
+        memcpy(node->values + node->count, next->values, next->count * sizeof(uint16_t));
+        node->count += next->count;
+        node->next = next->next;
+        if (list->tail == next) {
+            list->tail = node;
+        }
+        mem_free(next);
+    }
+
+    pthread_mutex_unlock(&list->lock);
+}
+
+// Searches for the first occurrence of the value
+UListPos ulist_search(UnrolledList* list, uint16_t data) {
+    pthread_mutex_lock(&list->lock);
+
+    UListPos pos = {NULL, 0};
+    for (UnrolledNode* node = list->head; node != NULL; node = node->next) {
+        uint32_t mask = node_match_mask(node, data);
+        if (mask) {
+            pos.node = node;
+            pos.index = __builtin_ctz(mask);
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&list->lock);
+    return pos;
+}
+
+// Counts the occurrences of the value
+size_t ulist_count_value(UnrolledList* list, uint16_t data) {
+    pthread_mutex_lock(&list->lock);
+
+    size_t count = 0;
+    for (UnrolledNode* node = list->head; node != NULL; node = node->next) {
+        count += __builtin_popcount(node_match_mask(node, data));
+    }
+
+    pthread_mutex_unlock(&list->lock);
+    return count;
+}
+
+// Displays all values in the list
+void ulist_display(UnrolledList* list) {
+    ulist_display_range(list, (UListPos){NULL, 0}, (UListPos){NULL, 0});
+    printf("\n");
+}
+
+// Displays the values from start to end inclusive; a NULL node means the first or
+// last value respectively
+void ulist_display_range(UnrolledList* list, UListPos start, UListPos end) {
+    pthread_mutex_lock(&list->lock);
+
+    UnrolledNode* node = start.node ? start.node : list->head;
+    int index = start.node ? start.index : 0;
+    int first = 1;
+
+    printf("[");
+    while (node != NULL) {
+        int last = (node == end.node) ? end.index : node->count - 1;
+        for (int i = index; i <= last; i++) {
+            printf(first ? "%u" : ", %u", node->values[i]);
+            first = 0;
+        }
+        if (node == end.node) {
+            break;
+        }
+        node = node->next;
+        index = 0;
+    }
+    printf("]");
+
+    pthread_mutex_unlock(&list->lock);
+}
+
+// Counts the values in the list
+size_t ulist_count_nodes(UnrolledList* list) {
+    pthread_mutex_lock(&list->lock);
+    size_t count = list->count;
+    pthread_mutex_unlock(&list->lock);
+    return count;
+}
+
+// Frees all nodes in the list and deallocates the memory manager
+void ulist_cleanup(UnrolledList* list) {
+    pthread_mutex_lock(&list->lock);
+
+    UnrolledNode* node = list->head;
+    while (node != NULL) {
+        UnrolledNode* next = node->next;
+        mem_free(node);
+        node = next;
+    }
+    list->head = NULL;
+    list->tail = NULL;
+    list->count = 0;
+
+    mem_deinit();
+
+    pthread_mutex_unlock(&list->lock);
+    pthread_mutex_destroy(&list->lock);
+}
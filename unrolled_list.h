@@ -0,0 +1,57 @@
+// unrolled_list.h
+#ifndef UNROLLED_LIST_H
+#define UNROLLED_LIST_H
+
+#include "memory_manager.h"
+#include <stdint.h>
+#include <pthread.h>
+
+// Values per node, chosen so that a node fills one 64-byte cache line
+#define ULIST_NODE_CAPACITY 27
+
+typedef struct UnrolledNode
+{
+    struct UnrolledNode *next;             // Pointer to the next node in the list
+    uint16_t count;                        // Number of values used in this node
+    uint16_t values[ULIST_NODE_CAPACITY];  // Values in list order
+} UnrolledNode;
+
+// Unrolled linked list: same semantics as the Node list, but each node stores
+// up to ULIST_NODE_CAPACITY values, so a traversal touches one cache line per
+// ULIST_NODE_CAPACITY elements instead of one per element.
+typedef struct UnrolledList
+{
+    UnrolledNode *head;
+    UnrolledNode *tail;
+    size_t count; // Number of values in the list
+    pthread_mutex_t lock;
+} UnrolledList;
+
+// Position of a value in an unrolled list; node is NULL for "no position"
+typedef struct UListPos
+{
+    UnrolledNode *node;
+    uint16_t index;
+} UListPos;
+
+// Function declarations
+void ulist_init(UnrolledList *list, size_t size);
+void ulist_insert(UnrolledList *list, uint16_t data);
+void ulist_insert_after(UnrolledList *list, UListPos pos, uint16_t data);
+void ulist_delete(UnrolledList *list, uint16_t data);
+UListPos ulist_search(UnrolledList *list, uint16_t data);
+
+void ulist_display(UnrolledList *list);
+void ulist_display_range(UnrolledList *list, UListPos start, UListPos end);
+
+size_t ulist_count_nodes(UnrolledList *list);
+void ulist_cleanup(UnrolledList *list);
+
+// Counts the occurrences of a value, scanning whole nodes with SIMD compares
+size_t ulist_count_value(UnrolledList *list, uint16_t data);
+
+// Searches compare a node's values with AVX2 or SSE2 when the CPU supports them,
+// picked at first use. Passing 0 forces the scalar loop (for benchmarks and tests).
+void ulist_use_simd(int enabled);
+
+#endif // UNROLLED_LIST_H